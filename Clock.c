@@ -0,0 +1,61 @@
+/*
+ * Clock Manager
+ *
+ * Changing CPDIV slows down the CPU and all peripherals clocked from Fcy
+ * at once, so the listeners adapt the timer and PMP settings right after
+ * the change, before any interrupt can see the new clock.
+ */
+#include "Clock.h"
+#include "IrqMask.h"
+
+ClockListener clockListeners[CLOCK_LISTENERS];
+uint8_t clockListenerCount = 0;
+uint8_t clockBase = CLOCK_HIGH;
+uint8_t clockBoosts = 0;
+uint8_t clockSpeed = CLOCK_HIGH;   // CPDIV value in effect
+
+void ClockInit(void) {
+    OSCCON = 0x3302;    // primary oscillator with PLL
+    CLKDIV = 0x0000;    // CPDIV 1:1
+    clockSpeed = CLOCK_HIGH;
+}
+
+uint32_t ClockFcy(void) {
+    return CLOCK_FCY_HIGH >> clockSpeed;
+}
+
+void ClockAddListener(ClockListener listener) {
+    if (clockListenerCount < CLOCK_LISTENERS) {
+        clockListeners[clockListenerCount++] = listener;
+    }
+}
+
+static void ClockApply(void) {
+    uint8_t speed = (clockBoosts > 0) ? CLOCK_HIGH : clockBase;
+    uint16_t current_ipl;
+    uint32_t masked;
+
+    if (speed == clockSpeed) return;
+    IRQ_MASK(current_ipl, masked);  // no interrupt between the steps
+    CLKDIV = (CLKDIV & ~0x00C0) | ((uint16_t)speed << 6);
+    clockSpeed = speed;
+    for (uint8_t i = 0; i < clockListenerCount; i++) {
+        clockListeners[i](ClockFcy());
+    }
+    IRQ_UNMASK(current_ipl, masked, IRQ_SITE_CLOCK);
+}
+
+void ClockSetBase(uint8_t speed) {
+    clockBase = speed;
+    ClockApply();
+}
+
+void ClockBoost(void) {
+    clockBoosts++;
+    ClockApply();
+}
+
+void ClockRelease(void) {
+    if (clockBoosts > 0) clockBoosts--;
+    ClockApply();
+}
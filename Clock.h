@@ -0,0 +1,45 @@
+/*
+ * Clock Manager - Header
+ *
+ * Single source of the instruction clock (Fcy). The 12 MHz crystal feeds
+ * the 96 MHz PLL, divided to a 32 MHz system clock; the CPU divider
+ * (CLKDIV.CPDIV) selects the speed:
+ *   CLOCK_HIGH: 32 MHz system clock, Fcy 16 MHz
+ *   CLOCK_LOW:   4 MHz system clock, Fcy  2 MHz
+ *
+ * The speed is the base speed (ClockSetBase) unless some code holds a
+ * boost (ClockBoost/ClockRelease), which runs the clock at CLOCK_HIGH.
+ * Modules whose timing depends on Fcy register a listener that is called
+ * with the new Fcy after every change, with interrupts off.
+ */
+#ifndef CLOCK__H
+#define	CLOCK__H
+
+#include <xc.h>
+
+#define CLOCK_CRYSTAL_HZ    12000000UL
+#define CLOCK_SYSTEM_HZ     32000000UL  // 96 MHz PLL / 3
+#define CLOCK_FCY_HIGH      (CLOCK_SYSTEM_HZ / 2)
+
+#define CLOCK_HIGH      0   // CPDIV value, 1:1
+#define CLOCK_LOW       3   // CPDIV value, 1:8
+#define CLOCK_LISTENERS 4
+
+typedef void (*ClockListener)(uint32_t fcy);
+
+// selects the PLL oscillator at CLOCK_HIGH
+void ClockInit(void);
+
+// instruction clock in Hz at the current speed
+uint32_t ClockFcy(void);
+
+void ClockAddListener(ClockListener listener);
+
+// speed when no boost is held
+void ClockSetBase(uint8_t speed);
+
+// run at CLOCK_HIGH until the matching ClockRelease(), may be nested
+void ClockBoost(void);
+void ClockRelease(void);
+
+#endif	/* CLOCK__H */
@@ -0,0 +1,62 @@
+/*
+ * Stackless Coroutines - Header
+ *
+ * Protothread-style coroutines built on a switch statement: a coroutine is
+ * a function that returns CO_WAITING whenever it has to wait and is called
+ * again later to continue where it stopped. The resume point is the source
+ * line, kept in a Coroutine together with a timer for CO_WAIT_MS.
+ *
+ *   uint8_t Blink(Coroutine* co) {
+ *       CO_BEGIN(co);
+ *       SetRGBs(255, 0, 0);
+ *       CO_WAIT_MS(co, 200);
+ *       SetRGBs(0, 0, 0);
+ *       CO_END(co);
+ *   }
+ *
+ * Rules: local variables are lost at every wait, keep what is needed
+ * after a wait in static variables. Do not put a wait inside a switch
+ * statement of the coroutine body.
+ */
+#ifndef COROUTINE__H
+#define	COROUTINE__H
+
+#include <xc.h>
+#include "SysTick.h"
+
+#define CO_WAITING  0   // coroutine has to be called again
+#define CO_DONE     1   // coroutine has finished
+
+typedef struct {
+    uint16_t line;      // resume point, 0 = start
+    uint32_t timer;     // start of the current CO_WAIT_MS
+} Coroutine;
+
+#define CO_INIT(co)         ((co)->line = 0)
+
+#define CO_BEGIN(co)        switch ((co)->line) { case 0:
+
+#define CO_END(co)          } (co)->line = 0; return CO_DONE
+
+// leave the coroutine here, continue after the statement on the next call
+#define CO_YIELD(co) \
+    do { (co)->line = __LINE__; return CO_WAITING; case __LINE__:; } while (0)
+
+// wait until cond is true, cond is checked again on every call
+#define CO_YIELD_UNTIL(co, cond) \
+    do { (co)->line = __LINE__; case __LINE__: \
+         if (!(cond)) return CO_WAITING; } while (0)
+
+#define CO_WAIT_MS(co, ms) \
+    do { (co)->timer = millis(); \
+         CO_YIELD_UNTIL(co, TIME_ELAPSED((co)->timer, (ms))); } while (0)
+
+// run a child coroutine to completion, child is its Coroutine and call the
+// call of the coroutine function (e.g. WaitForButton(&sub, &btn))
+#define CO_SPAWN(co, child, call) \
+    do { CO_INIT(child); CO_YIELD_UNTIL(co, (call) != CO_WAITING); } while (0)
+
+// finish early
+#define CO_EXIT(co)         do { (co)->line = 0; return CO_DONE; } while (0)
+
+#endif	/* COROUTINE__H */
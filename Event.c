@@ -0,0 +1,65 @@
+/*
+ * Event Bus
+ *
+ * One ring buffer for all topics keeps the events in publishing order.
+ * A handler may publish further events; they are delivered in the same
+ * EventTask() call.
+ */
+#include "Event.h"
+#include "SysTick.h"
+
+EventHandler subscribers[EVENT_TOPICS][EVENT_SUBSCRIBERS];
+uint8_t subscriberCount[EVENT_TOPICS];
+
+Event eventQueue[EVENT_QUEUE_SIZE];
+uint8_t eventHead;
+uint8_t eventTail;
+uint16_t eventDropped;
+
+void EventInit(void) {
+    for (uint8_t t = 0; t < EVENT_TOPICS; t++) {
+        subscriberCount[t] = 0;
+    }
+    eventHead = eventTail = 0;
+    eventDropped = 0;
+}
+
+uint8_t EventSubscribe(uint8_t topic, EventHandler handler) {
+    if (topic >= EVENT_TOPICS || subscriberCount[topic] >= EVENT_SUBSCRIBERS) {
+        return 0;
+    }
+    subscribers[topic][subscriberCount[topic]++] = handler;
+    return 1;
+}
+
+// take the oldest event and call its subscribers
+static void EventDeliver(void) {
+    Event e = eventQueue[eventTail];
+    eventTail = (eventTail + 1) & (EVENT_QUEUE_SIZE - 1);
+    for (uint8_t i = 0; i < subscriberCount[e.topic]; i++) {
+        subscribers[e.topic][i](&e);
+    }
+}
+
+void EventPublish(uint8_t topic, uint16_t arg) {
+    if (topic >= EVENT_TOPICS) return;
+    if (((eventHead + 1) & (EVENT_QUEUE_SIZE - 1)) == eventTail) {
+        if (eventDropped != 0xFFFF) eventDropped++;
+        return;
+    }
+    eventQueue[eventHead].topic = topic;
+    eventQueue[eventHead].arg = arg;
+    eventQueue[eventHead].timeMs = millis();
+    eventQueue[eventHead].wall = RtccNow();
+    eventHead = (eventHead + 1) & (EVENT_QUEUE_SIZE - 1);
+}
+
+uint16_t EventDropped(void) {
+    return eventDropped;
+}
+
+void EventTask(void) {
+    while (eventTail != eventHead) {
+        EventDeliver();
+    }
+}
@@ -0,0 +1,59 @@
+/*
+ * Event Bus - Header
+ *
+ * Publish/subscribe between modules without dynamic memory. Topics are
+ * compile-time IDs; each topic has a fixed table of subscribers. Published
+ * events wait in a ring buffer and are handed to the subscribers from
+ * EventTask(), so the publisher never runs the handlers itself. An event
+ * published into a full queue is dropped and counted (EventDropped).
+ *
+ *   EventSubscribe(EVENT_LOGIN_FAILED, LedFailure);
+ *   ...
+ *   EventPublish(EVENT_LOGIN_FAILED, userId);
+ *
+ * Publish from task context only, not from interrupts.
+ */
+#ifndef EVENT__H
+#define	EVENT__H
+
+#include <xc.h>
+#include "Rtcc.h"
+
+// topics, arg is the user ID unless noted
+#define EVENT_DB_CHANGED        0   // database or settings changed, arg 0
+#define EVENT_USER_REGISTERED   1
+#define EVENT_USER_DELETED      2
+#define EVENT_USER_UNLOCKED     3
+#define EVENT_LOGIN_OK          4
+#define EVENT_LOGIN_FAILED      5
+#define EVENT_USER_LOCKED       6   // failed attempt that locked the user
+#define EVENT_ADMIN_DENIED      7   // wrong admin password, arg 0
+#define EVENT_TOPICS            8
+
+#define EVENT_SUBSCRIBERS   4   // per topic
+#define EVENT_QUEUE_SIZE    16  // must be a power of 2
+
+typedef struct {
+    uint8_t topic;
+    uint16_t arg;
+    uint32_t timeMs;    // millis() when published
+    RtccTime wall;      // wall time when published
+} Event;
+
+typedef void (*EventHandler)(const Event* e);
+
+void EventInit(void);
+
+// returns 0 if the topic's subscriber table is full
+uint8_t EventSubscribe(uint8_t topic, EventHandler handler);
+
+// queue an event; with the queue full it is dropped
+void EventPublish(uint8_t topic, uint16_t arg);
+
+// events dropped on a full queue since power-up, saturates at 0xFFFF
+uint16_t EventDropped(void);
+
+// delivers the queued events to their subscribers
+void EventTask(void);
+
+#endif	/* EVENT__H */
@@ -0,0 +1,138 @@
+/*
+ * Program Flash
+ *
+ * NVMCON operations from the family reference manual (DS39715): page
+ * erase 0x4042, word program 0x4003, row program 0x4001. A row is
+ * programmed from the write latches, loaded with table writes first.
+ *
+ * Page pairs (Flash.h) have the tag in word FLASH_PAIR_WORDS; tags are
+ * compared with 8 bit wrap-around, and the two copies of a pair are
+ * never more than one sequence number apart.
+ */
+#include "Flash.h"
+#include "Supervisor.h"
+#include "IrqMask.h"
+
+// Keeps the linker from placing code or constants in the data pages; not
+// loaded, so programming the device leaves the pages erased. One word per
+// instruction word, two addresses each.
+const uint16_t flashData[(FLASH_DATA_END - FLASH_DATA_ADDR) / 2]
+    __attribute__((space(prog), address(FLASH_DATA_ADDR), noload));
+
+// disi #5 masks interrupts for the 6 cycles of the key sequence; the CPU
+// then stalls until the flash operation is done, a page erase at worst
+#define NVM_DISI_CYCLES 6
+#define NVM_STALL_CYCLES (FLASH_ERASE_US * (CLOCK_FCY_HIGH / 1000000UL))
+IRQ_MASK_STATIC_BOUND(NVM, NVM_DISI_CYCLES + NVM_STALL_CYCLES);
+
+// NVM unlock sequence using pure inline assembly from DS39897C Example 5-5.
+// This bypasses __builtin_write_NVM() to guarantee correct timing.
+// The 32 bit profiler counter (TMR4, then TMR5HLD latched by that read)
+// is read right before the disi and right after the nops, so the recorded
+// window is the masked sequence and the stall of the flash operation,
+// and not the call around it.
+static void NVMUnlock(void) {
+    uint16_t startLow, startHigh, endLow, endHigh;
+    asm volatile(
+        "mov     _TMR4, %0   \n\t"
+        "mov     _TMR5HLD, %1\n\t"
+        "disi    #5          \n\t"
+        "mov     #0x55, w0   \n\t"
+        "mov     w0, _NVMKEY \n\t"
+        "mov     #0xAA, w0   \n\t"
+        "mov     w0, _NVMKEY \n\t"
+        "bset    _NVMCON, #15\n\t"
+        "nop                 \n\t"
+        "nop                 \n\t"
+        "mov     _TMR4, %2   \n\t"
+        "mov     _TMR5HLD, %3"
+        : "=r"(startLow), "=r"(startHigh), "=r"(endLow), "=r"(endHigh) : : "w0"
+    );
+    uint32_t start = ((uint32_t)startHigh << 16) | startLow;
+    uint32_t end = ((uint32_t)endHigh << 16) | endLow;
+    // Timer4/5 ticks at the current Fcy, the sites record CLOCK_HIGH cycles
+    IrqMaskRecord(IRQ_SITE_NVM, (end - start) * (CLOCK_FCY_HIGH / ClockFcy()));
+}
+
+void FlashErasePage(uint32_t address) {
+    uint16_t offset;
+
+    TBLPAG = (uint16_t)(address >> 16);
+    offset = (uint16_t)(address & 0xFFFF);
+    __builtin_tblwtl(offset, 0x0000);
+    NVMCON = 0x4042;
+    NVMUnlock();
+    SUPERVISED_WAIT(NVMCONbits.WR, SUPERVISOR_SITE_NVM, FLASH_ERASE_US);
+    NVMCONbits.WREN = 0;
+}
+
+void FlashWriteWord(uint32_t address, uint16_t data) {
+    uint16_t offset;
+
+    NVMCON = 0x4003;
+    TBLPAG = (uint16_t)(address >> 16);
+    offset = (uint16_t)(address & 0xFFFF);
+    __builtin_tblwtl(offset, data);
+    __builtin_tblwth(offset, 0x00);
+    NVMUnlock();
+    SUPERVISED_WAIT(NVMCONbits.WR, SUPERVISOR_SITE_NVM, FLASH_WRITE_US);
+    NVMCONbits.WREN = 0;
+}
+
+void FlashWriteRow(uint32_t address, const uint16_t* data) {
+    uint16_t offset;
+
+    NVMCON = 0x4001;
+    TBLPAG = (uint16_t)(address >> 16);
+    offset = (uint16_t)(address & 0xFFFF);
+    for (uint8_t i = 0; i < FLASH_ROW_WORDS; i++) {
+        __builtin_tblwtl(offset, data[i]);
+        __builtin_tblwth(offset, 0x00);
+        offset += 2;
+    }
+    NVMUnlock();
+    SUPERVISED_WAIT(NVMCONbits.WR, SUPERVISOR_SITE_NVM, FLASH_ROW_US);
+    NVMCONbits.WREN = 0;
+}
+
+uint16_t FlashReadWord(uint32_t address) {
+    TBLPAG = (uint16_t)(address >> 16);
+    return __builtin_tblrdl((uint16_t)(address & 0xFFFF));
+}
+
+#define PAIR_TAG(seq)   ((uint16_t)(((uint16_t)(uint8_t)~(seq) << 8) | (uint8_t)(seq)))
+#define PAIR_NONE       -1      // copy never committed
+
+// sequence number of a copy, PAIR_NONE if the tag is not valid
+static int16_t PairSequence(uint32_t page) {
+    uint16_t tag = FlashReadWord(page + 2 * FLASH_PAIR_WORDS);
+    uint8_t seq = (uint8_t)tag;
+    return (tag == PAIR_TAG(seq)) ? seq : PAIR_NONE;
+}
+
+uint32_t FlashPairCurrent(uint32_t a, uint32_t b) {
+    int16_t seqA = PairSequence(a);
+    int16_t seqB = PairSequence(b);
+    if (seqB == PAIR_NONE) return a;
+    if (seqA == PAIR_NONE) return b;
+    return ((int8_t)(uint8_t)(seqB - seqA) > 0) ? b : a;
+}
+
+uint32_t FlashPairWrite(uint32_t current, uint32_t other,
+                        const uint16_t* data, uint16_t words) {
+    uint16_t row[FLASH_ROW_WORDS];
+    int16_t seq = PairSequence(current);  // PAIR_NONE + 1 = 0
+
+    FlashErasePage(other);
+    for (uint16_t first = 0; first < words; first += FLASH_ROW_WORDS) {
+        uint8_t blank = 1;
+        for (uint8_t i = 0; i < FLASH_ROW_WORDS; i++) {
+            // the tag and the words after the data stay erased
+            row[i] = (first + i < words) ? data[first + i] : 0xFFFF;
+            if (row[i] != 0xFFFF) blank = 0;
+        }
+        if (!blank) FlashWriteRow(other + 2 * (uint32_t)first, row);
+    }
+    FlashWriteWord(other + 2 * FLASH_PAIR_WORDS, PAIR_TAG(seq + 1));
+    return other;
+}
@@ -0,0 +1,74 @@
+/*
+ * Program Flash - Header
+ *
+ * Self-programming of the program flash for the database. Only the low
+ * 16 bits of each instruction word are used, so one data word sits at
+ * every even address and a page of FLASH_PAGE_SIZE addresses holds
+ * FLASH_PAGE_WORDS words. Erase is by page, programming by word or by
+ * row; programming can only clear bits, an erased word reads 0xFFFF.
+ *
+ * The erase and write waits are supervised (Supervisor.h). Run them at
+ * CLOCK_HIGH (ClockBoost) so the wait budgets hold.
+ *
+ * The data lives in FLASH_DATA_ADDR..FLASH_DATA_END, which Flash.c
+ * reserves with a noload section so the linker places no code there.
+ * The settings page, the UserStore pages, the journal and the second
+ * copies of the pages follow each other in it; each header checks with
+ * FLASH_LAYOUT_ASSERT() that its region starts after the previous one
+ * and fits.
+ *
+ * A page that is rewritten as a whole is kept as a page pair: two
+ * physical pages, of which the one not holding the current copy is
+ * erased and written, then committed by a tag word in its last word,
+ * sequence number in the low byte and its complement in the high byte.
+ * The copy with the newer sequence is current. A reset during the erase
+ * or the write leaves the tag of that copy invalid (erased, or bits of a
+ * half-erased tag set), so the other copy stays current and no page is
+ * ever lost. Each physical page is erased once per two writes.
+ */
+#ifndef FLASH__H
+#define	FLASH__H
+
+#include <xc.h>
+
+#define FLASH_PAGE_SIZE     0x400UL     // addresses per erase page
+#define FLASH_PAGE_WORDS    512         // data words per page
+#define FLASH_ROW_SIZE      0x80UL      // addresses per program row
+#define FLASH_ROW_WORDS     64          // data words per row
+#define FLASH_ROWS_PER_PAGE (FLASH_PAGE_WORDS / FLASH_ROW_WORDS)
+
+#define FLASH_DATA_ADDR     0x10000UL   // first data page
+#define FLASH_DATA_END      0x26800UL   // first address after the data
+#define FLASH_CONFIG_PAGE   0x2A800UL   // last page, holds the config words
+
+// fails the build if cond is false
+#define FLASH_LAYOUT_ASSERT(name, cond) \
+    typedef char flashLayout_##name[(cond) ? 1 : -1]
+
+FLASH_LAYOUT_ASSERT(DataBeforeConfig, FLASH_DATA_END <= FLASH_CONFIG_PAGE);
+
+#define FLASH_PAIR_WORDS    (FLASH_PAGE_WORDS - 1)  // data words of a pair page
+
+#define FLASH_ERASE_US   100000UL  // wait budget, page erase (typ. 20 ms)
+#define FLASH_WRITE_US   10000UL   // wait budget, word write (typ. 40 us)
+#define FLASH_ROW_US     20000UL   // wait budget, row write (typ. 2 ms)
+
+void FlashErasePage(uint32_t address);
+void FlashWriteWord(uint32_t address, uint16_t data);
+
+// programs FLASH_ROW_WORDS words at a row-aligned address
+void FlashWriteRow(uint32_t address, const uint16_t* data);
+
+uint16_t FlashReadWord(uint32_t address);
+
+// the page holding the current copy of the pair (a, b); a if neither
+// copy was committed, as in a page written before it was a pair
+uint32_t FlashPairCurrent(uint32_t a, uint32_t b);
+
+// writes words (up to FLASH_PAIR_WORDS) of data to other, the page of the
+// pair that is not current, and commits it; rows of 0xFFFF are not
+// programmed. Returns other, the new current page.
+uint32_t FlashPairWrite(uint32_t current, uint32_t other,
+                        const uint16_t* data, uint16_t words);
+
+#endif	/* FLASH__H */
@@ -0,0 +1,43 @@
+/*
+ * Interrupt Masking
+ *
+ * Windows come from ProfileCycles() and are already in CLOCK_HIGH cycles,
+ * also the ones that switch the clock (ClockApply).
+ */
+#include "IrqMask.h"
+
+ProfileEntry irqMaskTable[IRQ_SITES] = {
+    {"CTMU"}, {"CLOCK"}, {"NVM"},
+};
+uint16_t irqMaskOverruns[IRQ_SITES];
+const uint32_t irqMaskBudget[IRQ_SITES] = {
+    IRQ_MASK_BUDGET_CYCLES_CTMU, IRQ_MASK_BUDGET_CYCLES_CLOCK,
+    IRQ_MASK_BUDGET_CYCLES_NVM,
+};
+
+void IrqMaskReset(void) {
+    for (uint8_t site = 0; site < IRQ_SITES; site++) {
+        ProfileClear(&irqMaskTable[site]);
+        irqMaskOverruns[site] = 0;
+    }
+}
+
+void IrqMaskRecord(uint8_t site, uint32_t cycles) {
+    ProfileAdd(&irqMaskTable[site], cycles);
+    if (cycles > irqMaskBudget[site] && irqMaskOverruns[site] != 0xFFFF) {
+        irqMaskOverruns[site]++;
+    }
+}
+
+void IrqMaskBoundFailed(uint8_t site, uint32_t cycles) {
+    ProfileAdd(&irqMaskTable[site], cycles);
+    if (irqMaskOverruns[site] != 0xFFFF) irqMaskOverruns[site]++;
+}
+
+ProfileEntry* IrqMaskGet(uint8_t site) {
+    return &irqMaskTable[site];
+}
+
+uint16_t IrqMaskOverruns(uint8_t site) {
+    return irqMaskOverruns[site];
+}
@@ -0,0 +1,83 @@
+/*
+ * Interrupt Masking - Header
+ *
+ * Every place that masks interrupts is a site with a measured window:
+ * count, maximum and log2 histogram of the masked time, plus the number
+ * of windows over IRQ_MASK_BUDGET_US. That budget is the worst-case
+ * latency an interrupt-driven module can rely on.
+ *
+ *   uint16_t current_ipl;
+ *   uint32_t masked;
+ *   IRQ_MASK(current_ipl, masked);
+ *   ...  // short, bounded code
+ *   IRQ_UNMASK(current_ipl, masked, IRQ_SITE_CTMU);
+ *
+ * Sites whose length is known at compile time also state their bound
+ * with IRQ_MASK_STATIC_BOUND(), which fails the build if it exceeds the
+ * site's budget. Durations are in cycles at CLOCK_HIGH, taken from the profiler
+ * cycle counter (Profile.h).
+ */
+#ifndef IRQMASK__H
+#define	IRQMASK__H
+
+#include <xc.h>
+#include "Profile.h"
+#include "Clock.h"
+#include "Flash.h"
+
+// masking sites
+#define IRQ_SITE_CTMU   0   // ReadCTMU charge pulse, IPL 7
+#define IRQ_SITE_CLOCK  1   // ClockApply, IPL 7 over CLKDIV and listeners
+#define IRQ_SITE_NVM    2   // NVMUnlock key sequence, disi
+#define IRQ_SITES       3
+
+// longest allowed masked window
+#define IRQ_MASK_BUDGET_US      50
+#define IRQ_MASK_BUDGET_CYCLES  (IRQ_MASK_BUDGET_US * (CLOCK_FCY_HIGH / 1000000UL))
+
+// Per-site budgets. The NVM window is the disi key sequence and the CPU
+// stall of the flash operation it starts, up to a page erase; flash is
+// only written by the journal and the compactor, which are known to hold
+// off interrupts that long, so the site has the erase wait budget on top.
+#define IRQ_MASK_BUDGET_CYCLES_CTMU     IRQ_MASK_BUDGET_CYCLES
+#define IRQ_MASK_BUDGET_CYCLES_CLOCK    IRQ_MASK_BUDGET_CYCLES
+#define IRQ_MASK_BUDGET_CYCLES_NVM \
+    ((IRQ_MASK_BUDGET_US + FLASH_ERASE_US) * (CLOCK_FCY_HIGH / 1000000UL))
+
+// build fails if a site's worst case (CLOCK_HIGH cycles) is over budget
+#define IRQ_MASK_STATIC_BOUND(site, cycles) \
+    typedef char irqMaskBound_##site[((cycles) <= IRQ_MASK_BUDGET_CYCLES_##site) ? 1 : -1]
+
+#if PROFILE_ENABLE
+
+#define IRQ_MASK(saved, start) \
+    do { SET_AND_SAVE_CPU_IPL(saved, 7); (start) = ProfileCycles(); } while (0)
+
+// the time is taken before unmasking, the bookkeeping runs unmasked
+#define IRQ_UNMASK(saved, start, site) do {                               \
+        uint32_t irqMasked = ProfileCycles() - (start);                   \
+        RESTORE_CPU_IPL(saved);                                           \
+        IrqMaskRecord(site, irqMasked);                                   \
+    } while (0)
+
+#else
+
+#define IRQ_MASK(saved, start) \
+    do { SET_AND_SAVE_CPU_IPL(saved, 7); (void)(start); } while (0)
+#define IRQ_UNMASK(saved, start, site)  RESTORE_CPU_IPL(saved)
+
+#endif
+
+void IrqMaskReset(void);
+
+// adds one window of CLOCK_HIGH cycles
+void IrqMaskRecord(uint8_t site, uint32_t cycles);
+
+// adds the worst-case window of a site whose static bound was found wrong
+// at run time, counted as an overrun whatever its length
+void IrqMaskBoundFailed(uint8_t site, uint32_t cycles);
+
+ProfileEntry* IrqMaskGet(uint8_t site);
+uint16_t IrqMaskOverruns(uint8_t site);
+
+#endif	/* IRQMASK__H */
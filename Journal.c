@@ -0,0 +1,125 @@
+/*
+ * Flash Journal
+ *
+ * Positions are word indexes from JOURNAL_ADDR. journalEnd is the first
+ * free word; everything from there to the end of the journal is erased,
+ * which JournalInit() checks for the longest entry after the last one.
+ */
+#include "Journal.h"
+
+#define HEADER(type, arg)   ((uint16_t)(type) << 12 | ((arg) & 0x0FFF))
+#define ERASED              0xFFFF
+
+// data words per entry type
+const uint8_t journalData[JOURNAL_TYPES] = {
+    0, 6, 0, 1, 0, 0, 3,
+};
+
+uint16_t journalEnd;
+uint16_t journalGeneration;
+uint8_t journalDamaged;
+JournalCompactor journalCompactor;
+JournalStats journalStats;
+
+static uint32_t WordAddress(uint16_t pos) {
+    return JOURNAL_ADDR + 2 * (uint32_t)pos;
+}
+
+uint16_t JournalInit(JournalCompactor compactor) {
+    journalCompactor = compactor;
+    journalDamaged = 0;
+
+    uint16_t header = FlashReadWord(JOURNAL_ADDR);
+    if (header == ERASED || (header >> 12) != JOURNAL_BEGIN) {
+        journalGeneration = JOURNAL_NO_GENERATION;
+        journalEnd = 0;
+        journalDamaged = (header != ERASED);
+        return journalGeneration;
+    }
+    journalGeneration = header & 0x0FFF;
+
+    uint16_t pos = JOURNAL_FIRST;
+    while (pos < JOURNAL_WORDS) {
+        header = FlashReadWord(WordAddress(pos));
+        if (header == ERASED) break;
+        uint8_t type = header >> 12;
+        if (type == JOURNAL_BEGIN || type >= JOURNAL_TYPES
+                || pos + 1 + journalData[type] > JOURNAL_WORDS) {
+            journalDamaged = 1;
+            break;
+        }
+        pos += 1 + journalData[type];
+    }
+    journalEnd = pos;
+
+    // data of an append that lost power before its header
+    for (uint16_t i = 0; i <= JOURNAL_DATA_MAX && pos + i < JOURNAL_WORDS; i++) {
+        if (FlashReadWord(WordAddress(pos + i)) != ERASED) journalDamaged = 1;
+    }
+    return journalGeneration;
+}
+
+uint16_t JournalGeneration(void) {
+    return journalGeneration;
+}
+
+uint16_t JournalNextGeneration(uint16_t g) {
+    return g % 4094 + 1;
+}
+
+uint8_t JournalDamaged(void) {
+    return journalDamaged;
+}
+
+uint16_t JournalRead(uint16_t pos, JournalEntry* e) {
+    if (pos >= journalEnd) return JOURNAL_END;
+
+    uint16_t header = FlashReadWord(WordAddress(pos));
+    e->type = header >> 12;
+    e->arg = header & 0x0FFF;
+    for (uint8_t i = 0; i < journalData[e->type]; i++) {
+        e->data[i] = FlashReadWord(WordAddress(pos + 1 + i));
+    }
+    return pos + 1 + journalData[e->type];
+}
+
+uint8_t JournalAppend(uint8_t type, uint16_t arg, const uint16_t* data) {
+    uint8_t words = journalData[type];
+
+    if (journalDamaged || journalEnd + 1 + words > JOURNAL_WORDS) {
+        journalCompactor();
+        return 0;
+    }
+    for (uint8_t i = 0; i < words; i++) {
+        FlashWriteWord(WordAddress(journalEnd + 1 + i), data[i]);
+    }
+    FlashWriteWord(WordAddress(journalEnd), HEADER(type, arg));
+    journalEnd += 1 + words;
+    journalStats.appends++;
+    return 1;
+}
+
+void JournalReset(uint16_t generation) {
+    for (uint8_t page = 0; page < JOURNAL_PAGES; page++) {
+        uint32_t address = JOURNAL_ADDR + page * FLASH_PAGE_SIZE;
+        for (uint16_t i = 0; i < FLASH_PAGE_WORDS; i++) {
+            if (FlashReadWord(address + 2 * i) != ERASED) {
+                FlashErasePage(address);
+                break;
+            }
+        }
+    }
+    FlashWriteWord(JOURNAL_ADDR, HEADER(JOURNAL_BEGIN, generation));
+    journalGeneration = generation;
+    journalEnd = JOURNAL_FIRST;
+    journalDamaged = 0;
+    journalStats.resets++;
+}
+
+uint16_t JournalUsed(void) {
+    return journalEnd;
+}
+
+const JournalStats* JournalGetStats(void) {
+    return &journalStats;
+}
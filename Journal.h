@@ -0,0 +1,91 @@
+/*
+ * Flash Journal - Header
+ *
+ * Append-only log of database changes in program flash. A change costs a
+ * few programmed words at the end of the journal instead of erasing and
+ * rewriting the page it belongs to. At boot the journal is read back
+ * (JournalRead) on top of the pages; when it is full, the compactor that
+ * was passed to JournalInit() writes the current state to the pages and
+ * calls JournalReset().
+ *
+ * Entries hold absolute values (the new failed-attempt count, the whole
+ * record), so replaying an entry twice gives the same state. Each entry
+ * is one header word, type in bits 12-15 and a 12 bit argument, then
+ * journalData[type] data words. The data is programmed before the header,
+ * so an entry whose header reads erased was never completed.
+ *
+ * Every journal starts with a JOURNAL_BEGIN entry holding its generation.
+ * The compactor stores the generation it has applied with the pages; a
+ * journal of that generation found at boot was already applied.
+ */
+#ifndef JOURNAL__H
+#define	JOURNAL__H
+
+#include <xc.h>
+#include "Flash.h"
+
+#define JOURNAL_ADDR    0x1B000UL   // after the UserStore pages
+#define JOURNAL_PAGES   2
+#define JOURNAL_WORDS   (JOURNAL_PAGES * FLASH_PAGE_WORDS)
+FLASH_LAYOUT_ASSERT(JournalInData,
+                    JOURNAL_ADDR + JOURNAL_PAGES * FLASH_PAGE_SIZE <= FLASH_DATA_END);
+
+// entry types
+#define JOURNAL_BEGIN       0   // arg generation, first entry
+#define JOURNAL_REGISTER    1   // arg key; pattern, failed attempts, timing x4
+#define JOURNAL_DELETE      2   // arg key
+#define JOURNAL_FAILED      3   // arg key; failed attempts
+#define JOURNAL_UNLOCK      4   // arg key
+#define JOURNAL_PROFILE     5   // arg timing profile
+#define JOURNAL_STATS       6   // arg profile; transactions, total ms low, high
+#define JOURNAL_TYPES       7
+
+#define JOURNAL_DATA_MAX    6
+#define JOURNAL_FIRST       1       // JournalRead position of the first change
+#define JOURNAL_END         0xFFFF  // no more entries
+#define JOURNAL_NO_GENERATION   0   // erased journal
+
+typedef struct {
+    uint8_t type;
+    uint16_t arg;
+    uint16_t data[JOURNAL_DATA_MAX];
+} JournalEntry;
+
+typedef struct {
+    uint16_t appends;
+    uint16_t resets;        // erases by compaction or at boot
+} JournalStats;
+
+typedef void (*JournalCompactor)(void);
+
+extern const uint8_t journalData[JOURNAL_TYPES];
+
+// finds the end of the journal, returns its generation or
+// JOURNAL_NO_GENERATION if it is erased
+uint16_t JournalInit(JournalCompactor compactor);
+
+uint16_t JournalGeneration(void);
+
+// generation following g, 1-4094
+uint16_t JournalNextGeneration(uint16_t g);
+
+// 1 if JournalInit() found a torn or unknown entry; the journal ends
+// before it and has to be compacted before the next append
+uint8_t JournalDamaged(void);
+
+// entry at pos into *e, returns the position of the next entry or
+// JOURNAL_END; start with JOURNAL_FIRST
+uint16_t JournalRead(uint16_t pos, JournalEntry* e);
+
+// appends an entry, returns 1; with the journal full the compactor runs
+// instead, which must write the state this entry describes, and 0 is
+// returned
+uint8_t JournalAppend(uint8_t type, uint16_t arg, const uint16_t* data);
+
+// erases the journal (pages that are not blank) and begins generation
+void JournalReset(uint16_t generation);
+
+uint16_t JournalUsed(void);     // words
+const JournalStats* JournalGetStats(void);
+
+#endif	/* JOURNAL__H */
@@ -25,7 +25,10 @@
 #pragma config PLL_96MHZ = ON    // 96MHz PLL Disable->Enabled
 #pragma config PLLDIV = DIV3     // Oscillator input divided by 3 (12MHz input)
 #pragma config IESO = OFF        // IESO mode (Two-speed start-up)disabled
-#pragma config FWDTEN = OFF      // Watchdog Timer disabled
+#pragma config FWDTEN = OFF      // Watchdog Timer enabled by software (SWDTEN)
+#pragma config FWPSA = PR128     // Watchdog prescaler 1:128 (4 ms from LPRC)
+#pragma config WDTPS = PS256     // Watchdog postscaler 1:256, ~1 s timeout
+#pragma config WINDIS = OFF      // Watchdog in non-window mode
 #pragma config ICS = PGx2        // Emulator functions shared with PGEC1/PGED1
 #pragma config BKBUG = OFF       // Background Debug: resets in Operational mode
 #pragma config GWRP = OFF        // Writes to program memory allowed
@@ -35,7 +38,19 @@
 #include "SH1101A.h"
 #include "TouchSense.h"
 #include "RGBLeds.h"
-
-#define INIT_CLOCK() OSCCON = 0x3302; CLKDIV = 0x0000;
+#include "SysTick.h"
+#include "Scheduler.h"
+#include "Coroutine.h"
+#include "SoftTimer.h"
+#include "Power.h"
+#include "Profile.h"
+#include "Clock.h"
+#include "Event.h"
+#include "Supervisor.h"
+#include "IrqMask.h"
+#include "Rtcc.h"
+#include "Flash.h"
+#include "Journal.h"
+#include "UserStore.h"
 
 #endif	/* P24FS__H */
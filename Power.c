@@ -0,0 +1,80 @@
+/*
+ * Power Management
+ * 
+ * Idle stops the CPU but keeps the peripherals (Timer1, ADC, PMP, PWM)
+ * running, so the tick and the LEDs carry on. Sleep would also stop the
+ * Fcy-clocked Timer1 and the touch scan, so it is not used.
+ */
+#include "Power.h"
+#include "SysTick.h"
+
+PowerScreen* screens;
+uint8_t screenCount;
+uint8_t currentScreen;
+uint32_t screenEnterMs;  // millis() when the current screen was entered
+
+void PowerInit(PowerScreen* screenTable, uint8_t count) {
+    screens = screenTable;
+    screenCount = count;
+    for (uint8_t i = 0; i < count; i++) {
+        screens[i].wallMs = screens[i].idleMs = 0;
+        screens[i].idleUs = screens[i].visits = 0;
+    }
+    currentScreen = 0;
+    screenEnterMs = millis();
+    if (count > 0) screens[0].visits = 1;
+}
+
+void PowerSetScreen(uint8_t screen) {
+    if (screenCount == 0 || screen == currentScreen || screen >= screenCount) return;
+    uint32_t now = millis();
+    screens[currentScreen].wallMs += now - screenEnterMs;
+    screenEnterMs = now;
+    currentScreen = screen;
+    screens[screen].visits++;
+}
+
+PowerScreen* PowerGetScreen(uint8_t screen) {
+    return &screens[screen];
+}
+
+uint8_t PowerScreenCount(void) {
+    return screenCount;
+}
+
+// wall time including the current visit
+static uint32_t WallMs(uint8_t screen) {
+    uint32_t wall = screens[screen].wallMs;
+    if (screen == currentScreen) wall += millis() - screenEnterMs;
+    return wall;
+}
+
+uint8_t PowerCpuPercent(uint8_t screen) {
+    uint32_t wall = WallMs(screen);
+    uint32_t idle = screens[screen].idleMs;
+    if (wall == 0) return 0;
+    if (idle > wall) idle = wall;
+    return (uint8_t)((wall - idle) * 100 / wall);
+}
+
+uint32_t PowerCurrentUa(uint8_t screen) {
+    uint8_t cpu = PowerCpuPercent(screen);
+    return (POWER_RUN_UA * cpu + POWER_IDLE_UA * (100 - cpu)) / 100;
+}
+
+void PowerIdle(void) {
+    uint32_t start = micros();
+    Idle();
+    if (screenCount == 0) return;
+    PowerScreen* s = &screens[currentScreen];
+    uint32_t us = s->idleUs + (micros() - start);
+    s->idleMs += us / 1000;
+    s->idleUs = us % 1000;
+}
+
+void PowerWaitMs(uint16_t ms) {
+    uint32_t start = millis();
+    while (!TIME_ELAPSED(start, ms)) {
+        PowerIdle();
+    }
+}
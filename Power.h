@@ -0,0 +1,40 @@
+/*
+ * Power Management - Header
+ * 
+ * The CPU is put into Idle whenever the scheduler has nothing to run; the
+ * next interrupt (at the latest the 1 ms system tick) wakes it up again.
+ * Idle and wall time are accounted to the screen the UI reports with
+ * PowerSetScreen(), which gives the CPU load and an estimate of the
+ * average current per screen.
+ */
+#ifndef POWER__H
+#define	POWER__H
+
+#include <xc.h>
+
+// typical PIC24FJ256GB106 core current at 16 MIPS, 3.3 V (data sheet IDD
+// and IIDLE); display and LEDs are not included
+#define POWER_RUN_UA    17000UL
+#define POWER_IDLE_UA    4500UL
+
+typedef struct {
+    const char* name;
+    uint32_t wallMs;     // time spent on this screen, completed visits
+    uint32_t idleMs;     // time in Idle while on this screen
+    uint16_t idleUs;     // sub-millisecond remainder of idleMs
+    uint16_t visits;
+} PowerScreen;
+
+void PowerInit(PowerScreen* screenTable, uint8_t count);
+void PowerSetScreen(uint8_t screen);
+PowerScreen* PowerGetScreen(uint8_t screen);
+uint8_t PowerScreenCount(void);
+
+// CPU load in percent and estimated average current for a screen
+uint8_t PowerCpuPercent(uint8_t screen);
+uint32_t PowerCurrentUa(uint8_t screen);
+
+void PowerIdle(void);             // Idle until the next interrupt
+void PowerWaitMs(uint16_t ms);    // wait in Idle, needs the system tick
+
+#endif	/* POWER__H */
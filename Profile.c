@@ -0,0 +1,108 @@
+/*
+ * Function Profiler
+ *
+ * Timer4 and Timer5 form one 32 bit timer at Fcy without prescaler and
+ * without interrupt. Reading TMR4 latches TMR5 into TMR5HLD, so the two
+ * halves always belong together.
+ *
+ * The timer runs 8x slower at CLOCK_LOW. A clock listener adds the time
+ * counted so far to profileBase, in CLOCK_HIGH cycles, at every speed
+ * change. From there ProfileCycles() scales the ticks by the current
+ * speed, so a scope that switches the clock is still measured right.
+ */
+#include "Profile.h"
+#include "Clock.h"
+
+ProfileEntry profileTable[PROFILE_COUNT] = {
+    {"CTMU"}, {"FLUSH"}, {"STRING"}, {"FLASH"}, {"LOGIN"}, {"PATTRN"},
+    {"USRGET"}, {"COMMIT"},
+};
+
+void ProfileClear(ProfileEntry* e) {
+    e->count = 0;
+    e->minCycles = 0xFFFFFFFFUL;
+    e->maxCycles = 0;
+    e->totalCycles = 0;
+    for (uint8_t i = 0; i < PROFILE_BUCKETS; i++) {
+        e->histogram[i] = 0;
+    }
+}
+
+uint32_t profileBase;   // CLOCK_HIGH cycles up to the last speed change
+uint32_t profileEpoch;  // timer value at the last speed change
+uint8_t profileShift;   // log2(CLOCK_FCY_HIGH / Fcy)
+
+static uint32_t ProfileTimer(void) {
+    uint16_t low = TMR4;
+    return ((uint32_t)TMR5HLD << 16) | low;
+}
+
+// called with interrupts off, before the new speed can be seen
+static void ProfileClockChanged(uint32_t fcy) {
+    uint32_t now = ProfileTimer();
+    profileBase += (now - profileEpoch) << profileShift;
+    profileEpoch = now;
+    profileShift = 0;
+    while ((CLOCK_FCY_HIGH >> profileShift) > fcy) profileShift++;
+}
+
+void ProfileReset(void) {
+    for (uint8_t id = 0; id < PROFILE_COUNT; id++) {
+        ProfileClear(&profileTable[id]);
+    }
+}
+
+void ProfileInit(void) {
+    T4CON = 0x0000;
+    T5CON = 0x0000;
+    T4CON = 0x0008;  // 32 bit mode (Timer4/5), Fcy, prescale 1:1
+    PR5 = 0xFFFF; PR4 = 0xFFFF;
+    TMR5HLD = 0; TMR4 = 0;  // TMR4 write also loads TMR5 from TMR5HLD
+    IEC1bits.T5IE = 0;
+    T4CONbits.TON = 1;
+    profileBase = profileEpoch = 0;
+    profileShift = 0;
+    ProfileClockChanged(ClockFcy());
+    ClockAddListener(ProfileClockChanged);
+    ProfileReset();
+}
+
+uint32_t ProfileCycles(void) {
+    return profileBase + ((ProfileTimer() - profileEpoch) << profileShift);
+}
+
+ProfileMark ProfileEnter(uint8_t id) {
+    ProfileMark mark;
+    mark.id = id;
+    mark.start = ProfileCycles();
+    return mark;
+}
+
+void ProfileExit(ProfileMark* mark) {
+    uint32_t cycles = ProfileCycles() - mark->start;
+    ProfileAdd(&profileTable[mark->id], cycles);
+}
+
+void ProfileAdd(ProfileEntry* e, uint32_t cycles) {
+    e->count++;
+    e->totalCycles += cycles;
+    if (cycles < e->minCycles) e->minCycles = cycles;
+    if (cycles > e->maxCycles) e->maxCycles = cycles;
+
+    // bucket = number of significant bits of cycles
+    uint8_t bucket = 0;
+    uint32_t c = cycles;
+    if (c >> 16) { bucket = 16; c >>= 16; }
+    while (c) { bucket++; c >>= 1; }
+    if (bucket >= PROFILE_BUCKETS) bucket = PROFILE_BUCKETS - 1;
+    if (e->histogram[bucket] != 0xFFFF) e->histogram[bucket]++;
+}
+
+ProfileEntry* ProfileGet(uint8_t id) {
+    return &profileTable[id];
+}
+
+uint32_t ProfileMeanCycles(uint8_t id) {
+    ProfileEntry* e = &profileTable[id];
+    return (e->count > 0) ? (uint32_t)(e->totalCycles / e->count) : 0;
+}
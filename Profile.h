@@ -0,0 +1,88 @@
+/*
+ * Function Profiler - Header
+ *
+ * PROFILE_SCOPE(id) at the top of a function measures the time until the
+ * function returns, on any return path, in instruction cycles at
+ * CLOCK_HIGH, counted by the free-running 32 bit Timer4/5 at any speed.
+ * Count, min, max, total and a log2 histogram are kept per id in a fixed
+ * RAM table.
+ *
+ *   void DrawString(int16_t x, int16_t y, const char* str) {
+ *       PROFILE_SCOPE(PROF_DRAW_STRING);
+ *       ...
+ *   }
+ *
+ * A scope costs two timer reads and a table update, so it belongs on
+ * functions that run for hundreds of cycles or more, not on PutPixel.
+ * Build with PROFILE_ENABLE=0 to compile the scopes out completely.
+ * Timings are inclusive (DrawString includes its PutPixel calls) and
+ * include interrupts that hit the scope.
+ */
+#ifndef PROFILE__H
+#define	PROFILE__H
+
+#include <xc.h>
+
+#ifndef PROFILE_ENABLE
+#define PROFILE_ENABLE  1
+#endif
+
+// profiled functions
+#define PROF_READ_CTMU          0
+#define PROF_DISPLAY_FLUSH      1
+#define PROF_DRAW_STRING        2
+#define PROF_FLASH_WRITE        3
+#define PROF_VALIDATE_LOGIN     4
+#define PROF_PATTERN_DISPLAY    5
+#define PROF_USER_GET           6
+#define PROF_USER_COMMIT        7
+#define PROFILE_COUNT           8
+
+// bucket i counts durations of 2^(i-1) to 2^i - 1 cycles, the last one
+// everything from 2^(PROFILE_BUCKETS-2) cycles (16 ms at 16 MHz) up
+#define PROFILE_BUCKETS 20
+
+typedef struct {
+    const char* name;
+    uint32_t count;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint64_t totalCycles;
+    uint16_t histogram[PROFILE_BUCKETS];  // saturates at 0xFFFF
+} ProfileEntry;
+
+typedef struct {
+    uint8_t id;
+    uint32_t start;
+} ProfileMark;
+
+#if PROFILE_ENABLE
+
+#define PROFILE_SCOPE(id) \
+    ProfileMark profileMark __attribute__((cleanup(ProfileExit))) = ProfileEnter(id)
+
+#else
+
+#define PROFILE_SCOPE(id)   ((void)0)
+
+#endif
+
+// starts the cycle counter (Timer4/5), clears the table
+void ProfileInit(void);
+void ProfileReset(void);
+
+// CLOCK_HIGH cycles since ProfileInit(), wraps after 268 s; at CLOCK_LOW
+// it advances in steps of 8
+uint32_t ProfileCycles(void);
+
+ProfileMark ProfileEnter(uint8_t id);
+void ProfileExit(ProfileMark* mark);
+
+// statistics of one entry, also for tables kept outside the profiler
+void ProfileClear(ProfileEntry* e);
+void ProfileAdd(ProfileEntry* e, uint32_t cycles);
+
+ProfileEntry* ProfileGet(uint8_t id);
+uint32_t ProfileMeanCycles(uint8_t id);
+
+#endif	/* PROFILE__H */
@@ -6,6 +6,13 @@
  * Original driver by: kvl@eti.uni-siegen.de
  */
 #include "RGBLeds.h"
+#include "SoftTimer.h"
+
+// blink sequence state (RGBBlink / BlinkStep)
+uint8_t blinkColor[3];
+uint8_t blinkPhases;     // on and off phases left, on when even
+uint16_t blinkOnMs, blinkOffMs;
+SoftTimer blinkTimer;
 
 // set new PWM output 
 void SetRGBs( uint8_t satR, uint8_t satG, uint8_t satB ) {
@@ -52,3 +59,28 @@ void RGBTurnOnLED() {
     ODCG = 0x03C0;       // green and blue    
     T2CON = 0x8000;  // turn on timer
 }
+
+// switch to the next on/off phase, timer callback
+static void BlinkStep(SoftTimer* t) {
+    if (blinkPhases == 0) return;
+    if (blinkPhases & 1) {
+        SetRGBs(0, 0, 0);           // off phase
+        TimerStart(t, blinkOffMs, 0, BlinkStep);
+    } else {
+        SetRGBs(blinkColor[0], blinkColor[1], blinkColor[2]);
+        TimerStart(t, blinkOnMs, 0, BlinkStep);
+    }
+    blinkPhases--;
+}
+
+void RGBBlink(uint8_t satR, uint8_t satG, uint8_t satB,
+              uint8_t times, uint16_t onMs, uint16_t offMs) {
+    blinkColor[0] = satR; blinkColor[1] = satG; blinkColor[2] = satB;
+    blinkOnMs = onMs; blinkOffMs = offMs;
+    blinkPhases = times * 2;
+    BlinkStep(&blinkTimer);
+}
+
+uint8_t RGBBlinking(void) {
+    return blinkPhases > 0;
+}
@@ -28,4 +28,10 @@ void RGBTurnOffLED();
 // turns on the LEDs by turning on timers, PWMs, and setting pins to outputs
 void RGBTurnOnLED();
 
+// blink a color 'times' times without blocking, replaces a running blink;
+// the phases are timed by a software timer (SoftTimer.c)
+void RGBBlink(uint8_t satR, uint8_t satG, uint8_t satB,
+              uint8_t times, uint16_t onMs, uint16_t offMs);
+uint8_t RGBBlinking(void);
+
 #endif	/* RGBLEDS__H */
@@ -0,0 +1,172 @@
+/*
+ * Real-Time Clock
+ *
+ * The RTCC registers are BCD and read through the RTCVAL window, starting
+ * at RTCPTR = 3 (year) and counting down. They are read only in RtccInit()
+ * and written only in RtccSet(); in between the alarm interrupt keeps the
+ * RAM copy, which changes on the same second boundary as the RTCC.
+ */
+#include "Rtcc.h"
+
+#define RTCC_SET_MAGIC  0xC10C
+#define SECONDS_PER_DAY 86400UL
+
+volatile RtccTime rtccSeconds;   // counted by the alarm interrupt
+volatile RtccTime rtccUptime;    // the same ticks, never set
+
+// not cleared by the startup code, RTCC_SET_MAGIC once the time was set
+uint16_t rtccSetFlag __attribute__((persistent));
+
+// days before each month in a non-leap year
+const uint16_t daysBeforeMonth[12] = {
+    0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334,
+};
+
+static uint8_t ToBcd(uint8_t v) {
+    return (uint8_t)(((v / 10) << 4) | (v % 10));
+}
+
+static uint8_t FromBcd(uint8_t v) {
+    return (uint8_t)((v >> 4) * 10 + (v & 0x0F));
+}
+
+static uint8_t IsLeap(uint8_t year) {
+    return (year % 4) == 0;  // 2000 is a leap year, 2100 is out of range
+}
+
+uint8_t RtccDaysInMonth(uint8_t year, uint8_t month) {
+    if (month == 2) return IsLeap(year) ? 29 : 28;
+    if (month == 4 || month == 6 || month == 9 || month == 11) return 30;
+    return 31;
+}
+
+RtccTime RtccFromDate(const RtccDate* d) {
+    uint32_t days = (uint32_t)d->year * 365 + (d->year + 3) / 4
+        + daysBeforeMonth[d->month - 1] + d->day - 1;
+    if (d->month > 2 && IsLeap(d->year)) days++;
+    return days * SECONDS_PER_DAY
+        + (uint32_t)d->hour * 3600 + (uint16_t)d->minute * 60 + d->second;
+}
+
+void RtccToDate(RtccTime t, RtccDate* d) {
+    uint16_t days = (uint16_t)(t / SECONDS_PER_DAY);
+    uint32_t rest = t % SECONDS_PER_DAY;
+
+    d->hour = (uint8_t)(rest / 3600);
+    d->minute = (uint8_t)((rest % 3600) / 60);
+    d->second = (uint8_t)(rest % 60);
+
+    d->year = 0;
+    while (days >= (IsLeap(d->year) ? 366 : 365)) {
+        days -= IsLeap(d->year) ? 366 : 365;
+        d->year++;
+    }
+    d->month = 1;
+    while (days >= RtccDaysInMonth(d->year, d->month)) {
+        days -= RtccDaysInMonth(d->year, d->month);
+        d->month++;
+    }
+    d->day = (uint8_t)(days + 1);
+}
+
+// reads all four registers twice until both reads agree (no rollover)
+static RtccTime RtccRead(void) {
+    uint16_t v[4], check[4];
+    uint8_t same;
+    do {
+        RCFGCALbits.RTCPTR = 3;
+        for (uint8_t i = 0; i < 4; i++) v[i] = RTCVAL;
+        RCFGCALbits.RTCPTR = 3;
+        same = 1;
+        for (uint8_t i = 0; i < 4; i++) {
+            check[i] = RTCVAL;
+            if (check[i] != v[i]) same = 0;
+        }
+    } while (!same);
+
+    RtccDate d;
+    d.year = FromBcd(v[0] & 0xFF);
+    d.month = FromBcd(v[1] >> 8);
+    d.day = FromBcd(v[1] & 0xFF);
+    d.hour = FromBcd(v[2] & 0xFF);
+    d.minute = FromBcd(v[3] >> 8);
+    d.second = FromBcd(v[3] & 0xFF);
+    if (d.month < 1 || d.month > 12 || d.day < 1) return 0;  // never set
+    return RtccFromDate(&d);
+}
+
+static void RtccWrite(RtccTime t) {
+    RtccDate d;
+    RtccToDate(t, &d);
+    uint8_t weekday = (uint8_t)((t / SECONDS_PER_DAY + 6) % 7);  // 2000-01-01: Sat
+
+    __builtin_write_RTCWEN();
+    RCFGCALbits.RTCEN = 0;
+    RCFGCALbits.RTCPTR = 3;
+    RTCVAL = ToBcd(d.year);
+    RTCVAL = ((uint16_t)ToBcd(d.month) << 8) | ToBcd(d.day);
+    RTCVAL = ((uint16_t)weekday << 8) | ToBcd(d.hour);
+    RTCVAL = ((uint16_t)ToBcd(d.minute) << 8) | ToBcd(d.second);
+    RCFGCALbits.RTCEN = 1;
+    RCFGCALbits.RTCWREN = 0;
+}
+
+void RtccInit(uint8_t coldStart) {
+    IEC3bits.RTCIE = 0;
+    if (coldStart || rtccSetFlag != RTCC_SET_MAGIC || !RCFGCALbits.RTCEN) {
+        rtccSetFlag = 0;
+        RtccWrite(0);
+    }
+
+    ALCFGRPTbits.ALRMEN = 0;
+    ALCFGRPT = 0xC400;  // alarm on, chime, every second
+    rtccSeconds = RtccRead();
+
+    IPC15bits.RTCIP = RTCC_IPL;
+    IFS3bits.RTCIF = 0;
+    IEC3bits.RTCIE = 1;
+}
+
+void __attribute__((__interrupt__, no_auto_psv)) _RTCCInterrupt(void) {
+    rtccSeconds++;
+    rtccUptime++;
+    IFS3bits.RTCIF = 0;
+}
+
+// 32 bit read of the seconds counter, repeated if the interrupt hit
+RtccTime RtccNow(void) {
+    RtccTime t;
+    do {
+        t = rtccSeconds;
+    } while (t != rtccSeconds);
+    return t;
+}
+
+RtccTime RtccUptime(void) {
+    RtccTime t;
+    do {
+        t = rtccUptime;
+    } while (t != rtccUptime);
+    return t;
+}
+
+uint8_t RtccIsSet(void) {
+    return rtccSetFlag == RTCC_SET_MAGIC;
+}
+
+uint8_t RtccSet(const RtccDate* d) {
+    if (d->year > 99 || d->month < 1 || d->month > 12 || d->day < 1
+            || d->day > RtccDaysInMonth(d->year, d->month)
+            || d->hour > 23 || d->minute > 59 || d->second > 59) {
+        return 0;
+    }
+    RtccTime t = RtccFromDate(d);
+
+    IEC3bits.RTCIE = 0;
+    RtccWrite(t);
+    rtccSeconds = t;
+    IFS3bits.RTCIF = 0;
+    IEC3bits.RTCIE = 1;
+    rtccSetFlag = RTCC_SET_MAGIC;
+    return 1;
+}
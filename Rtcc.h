@@ -0,0 +1,59 @@
+/*
+ * Real-Time Clock - Header
+ *
+ * Wall time from the RTCC, clocked by the 32.768 kHz secondary oscillator
+ * (SOSCEN is set by ClockInit). Times are RtccTime values, seconds since
+ * 2000-01-01 00:00:00, valid up to 2099.
+ *
+ * The RTCC alarm interrupts once per second and counts a RAM copy of the
+ * time, so RtccNow() is as cheap as millis() and the audit log stores
+ * plain numbers instead of reading the RTCC. The same interrupt counts
+ * RtccUptime(), which setting the clock does not move: deadlines (lockout,
+ * sessions) use it, the wall time is only for display and logging.
+ * The RTCC keeps running through every reset except power-on, and the
+ * "clock set" flag is kept in RAM the startup code does not clear.
+ */
+#ifndef RTCC__H
+#define	RTCC__H
+
+#include <xc.h>
+
+#define RTCC_IPL    2   // alarm interrupt priority, below the tick
+
+typedef uint32_t RtccTime;
+
+typedef struct {
+    uint8_t year;       // 0-99 = 2000-2099
+    uint8_t month;      // 1-12
+    uint8_t day;        // 1-31
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+} RtccDate;
+
+// overflow-safe comparison, a at or after b
+#define RTCC_AFTER(a, b)    ((int32_t)((uint32_t)(a) - (uint32_t)(b)) >= 0)
+
+// starts the RTCC and its seconds alarm; after power-on (coldStart) the
+// clock starts unset at 2000-01-01
+void RtccInit(uint8_t coldStart);
+
+// current wall time
+RtccTime RtccNow(void);
+
+// seconds since the boot, monotonic across RtccSet()
+RtccTime RtccUptime(void);
+
+// 1 once the time was set from the admin menu
+uint8_t RtccIsSet(void);
+
+// sets the RTCC and marks the clock set, returns 0 for an invalid date
+uint8_t RtccSet(const RtccDate* d);
+
+// days in month (1-12) of year (0-99)
+uint8_t RtccDaysInMonth(uint8_t year, uint8_t month);
+
+void RtccToDate(RtccTime t, RtccDate* d);
+RtccTime RtccFromDate(const RtccDate* d);
+
+#endif	/* RTCC__H */
@@ -8,6 +8,10 @@
  * Extended with text/graphics by: AdityaDk10
  */
 #include "SH1101A.h"
+#include "Power.h"
+#include "Profile.h"
+#include "Clock.h"
+#include "Supervisor.h"
 
 uint8_t _color;
 
@@ -16,18 +20,20 @@ uint8_t _color;
 	DisplaySetCommand(); DeviceWrite(page); DeviceWrite(lowerAddr); \
     DeviceWrite(higherAddr); DisplaySetData();
 
-#define AssignPageAddress(y) \
-    if (y < 8) page = 0xB0; else if (y < 16) page = 0xB1; \
-    else if (y < 24) page = 0xB2; else if (y < 32) page = 0xB3; \
-    else if (y < 40) page = 0xB4; else if (y < 48) page = 0xB5; \
-    else if (y < 56) page = 0xB6; else page = 0xB7
+// A bus cycle is a few dozen Fcy cycles (wait states included), each
+// iteration of the wait at least 3; micros() per byte would double the
+// cost of a flush
+#define PMP_WAIT_LOOPS  1000
 
-#define PMPWaitBusy()   while(PMMODEbits.BUSY)  // wait for PMP cycle end
+// wait for PMP cycle end
+#define PMPWaitBusy()   \
+    SUPERVISED_WAIT_LOOPS(PMMODEbits.BUSY, SUPERVISOR_SITE_PMP, PMP_WAIT_LOOPS)
 
-// a software delay in intervals of 10 microseconds.
+// a software delay in intervals of 10 microseconds, calibrated to the
+// current instruction clock
 void Delay10us( uint32_t tenMicroSecondCounter ) {
     volatile int32_t cyclesRequiredForDelay;  //7 cycles burned to this point 
-    cyclesRequiredForDelay = (int32_t)(CLOCK_FREQ/100000)*tenMicroSecondCounter;
+    cyclesRequiredForDelay = (int32_t)(ClockFcy()/100000)*tenMicroSecondCounter;
     // subtract all  cycles used up til while loop below, each loop cycle count
     // is subtracted (subtract the 5 cycle function return)
     cyclesRequiredForDelay -= 44; //(29 + 5) + 10 cycles padding
@@ -41,9 +47,14 @@ void Delay10us( uint32_t tenMicroSecondCounter ) {
     }
 }
 
-// performs a software delay in intervals of 1 millisecond
+// performs a delay in intervals of 1 millisecond, in Idle once the
+// system tick (Timer1) runs
 void DelayMs( uint16_t ms ) {
     volatile uint8_t i;        
+    if (T1CONbits.TON) {
+        PowerWaitMs(ms);
+        return;
+    }
     while (ms--) {
         i = 4;
         while (i--) {
@@ -89,20 +100,11 @@ extern inline uint16_t __attribute__ ((always_inline)) DeviceReadWord() {
     return value;
 }
 
-// initializes the OLED device
-extern inline void __attribute__ ((always_inline)) DriverInterfaceInit(void) { 
-    // variable for PMP timing calculation
-	// CLOCK_FREQ in MHz => pClockPeriod in nanoseconds
-    uint32_t pClockPeriod = (1000000000ul) / CLOCK_FREQ;
-	DisplayResetEnable();               // hold in reset by default
-    DisplayResetConfig();               // enable RESET line
-    DisplayCmdDataConfig();             // enable RS line
-    DisplayDisable();                   // not selected by default
-    DisplayConfig();                    // enable chip select line
-    // PMP setup
-    PMMODE = 0; PMAEN = 0; PMCON = 0;
-    PMMODEbits.MODE = 2;                // Intel 80 master interface
-    PMMODEbits.WAITB = 0;
+// PMP wait states for the SH1101A access times at the given Fcy, also
+// called as clock listener
+static void PMPSetTiming(uint32_t fcy) {
+    // Fcy in Hz => pClockPeriod in nanoseconds
+    uint32_t pClockPeriod = (1000000000ul) / fcy;
     #if (PMP_DATA_WAIT_TIME == 0)
         PMMODEbits.WAITM = 0;
     #else    
@@ -119,6 +121,21 @@ extern inline void __attribute__ ((always_inline)) DriverInterfaceInit(void) {
         else if (PMP_DATA_HOLD_TIME > pClockPeriod)
             PMMODEbits.WAITE = (PMP_DATA_HOLD_TIME / pClockPeriod) + 1;
     #endif
+}
+
+// initializes the OLED device
+extern inline void __attribute__ ((always_inline)) DriverInterfaceInit(void) { 
+	DisplayResetEnable();               // hold in reset by default
+    DisplayResetConfig();               // enable RESET line
+    DisplayCmdDataConfig();             // enable RS line
+    DisplayDisable();                   // not selected by default
+    DisplayConfig();                    // enable chip select line
+    // PMP setup
+    PMMODE = 0; PMAEN = 0; PMCON = 0;
+    PMMODEbits.MODE = 2;                // Intel 80 master interface
+    PMMODEbits.WAITB = 0;
+    PMPSetTiming(ClockFcy());
+    ClockAddListener(PMPSetTiming);
     PMMODEbits.MODE16 = 0;              // 8 bit mode
     PMCONbits.PTRDEN =  PMCONbits.PTWREN = 1;  // enable WR & RD line
     PMCONbits.PMPEN = 1;                // enable PMP
@@ -126,7 +143,20 @@ extern inline void __attribute__ ((always_inline)) DriverInterfaceInit(void) {
     Delay10us(20);  // hard delay for devices that need it after reset
 }
 
-void ResetDevice(void) {
+// Drawing goes to a RAM copy of the display; DisplayFlush() copies the
+// columns that changed since the last flush to the controller. A page is
+// 8 rows, bit 0 is the top row of the page.
+uint8_t frameBuffer[8][DISP_HOR_RESOLUTION];
+uint8_t dirtyMin[8];   // first changed column per page
+uint8_t dirtyMax[8];   // last changed column per page, < dirtyMin = clean
+
+uint8_t displayReady = 0;  // 1 = DisplayStart() done, flushes go out
+uint8_t displayShown = 0;  // 1 = the first frame reached the panel
+
+// First part of the initialization: interface, panel configuration and
+// DC-DC converter on. The panel needs DISPLAY_POWERUP_MS before
+// DisplayStart(), other initialization can run meanwhile.
+void DisplayPowerUp(void) {
 	DriverInterfaceInit();  // Initialize the device
     DisplayEnable();
 	DisplaySetCommand();
@@ -143,77 +173,129 @@ void ResetDevice(void) {
     DeviceWrite(0xD5);             // set display clock divide
     DeviceWrite(0xA0);             // set to 100Hz
     DeviceWrite(0x81);             // Set contrast control
-    DeviceWrite(0x60);             // display 0 ~ 127; 2C
+    DeviceWrite(CONTRAST_NORMAL);  // display 0 ~ 127; 2C
     DeviceWrite(0xD3);             // Display Offset: set display offset
     DeviceWrite(0x00);             // no offset
     DeviceWrite(0xA6);             //Normal or Inverse Display: Normal display
     DeviceWrite(0xAD);             // Set DC-DC
     DeviceWrite(0x8B);             // 8B=ON, 8A=OFF
     DeviceWrite(0xAF);             // Display ON/OFF: AF=ON, AE=OFF
-    DelayMs(150);
+    DisplayDisable(); DisplaySetData();
+}
+
+// Second part: blank the display RAM, then let DisplayFlush() send the
+// whole frame buffer, which may already hold the first screen
+void DisplayStart(void) {
+    DisplayEnable();
+    DisplaySetCommand();
     DeviceWrite(0xA4);             // Entire Display ON/OFF: A4=ON
     DeviceWrite(0x40);             // Set display start line
     DeviceWrite(0x00 + OFFSET);    // Set lower column address
     DeviceWrite(0x10);             // Set higher column address
     DelayMs(1);
+    for(uint8_t i = 0xB0; i < 0xB8; i++) {  // blank all 8 pages, 132 bytes
+        SetAddress(i, 0x00, 0x10);
+        for(uint8_t j = 0; j < 132; j++)
+            DeviceWrite(0x00);
+    }
     DisplayDisable(); DisplaySetData();
+    for (uint8_t page = 0; page < 8; page++) {
+        dirtyMin[page] = 0;
+        dirtyMax[page] = DISP_HOR_RESOLUTION - 1;
+    }
+    displayReady = 1;
+}
+
+uint8_t DisplayReady(void) {
+    return displayReady;
+}
+
+uint8_t DisplayShown(void) {
+    return displayShown;
+}
+
+static void MarkDirty(uint8_t page, uint8_t x) {
+    if (dirtyMax[page] < dirtyMin[page]) {
+        dirtyMin[page] = dirtyMax[page] = x;
+    } else if (x < dirtyMin[page]) {
+        dirtyMin[page] = x;
+    } else if (x > dirtyMax[page]) {
+        dirtyMax[page] = x;
+    }
 }
 
 // puts pixel
 void PutPixel(int16_t x, int16_t y) {
-    uint8_t page, add, lAddr, hAddr;
-    uint8_t mask, display;
-    // Assign a page address
-    AssignPageAddress(y);
-    add = x + OFFSET;
-    lAddr = 0x0F & add; hAddr = 0x10 | (add >> 4);  // low + high address
-    // Calculate mask from rows basically do a y%8 and remainder is bit position
-    add = y >> 3;                   // Divide by 8
-    add <<= 3;                      // Multiply by 8
-    add = y - add;                  // Calculate bit position
-    mask = 1 << add;                // Left shift 1 by bit position
-    DisplayEnable();
-    SetAddress(page, lAddr, hAddr); // Set the address (sets the page,
-    // lower and higher column address pointers)
-    display = SingleDeviceRead();	// initiate Read transaction on PMP  								
-    display = SingleDeviceRead();	// for synchronization in the controller
-    display = SingleDeviceRead();	// read actual data from display buffer
-    if (_color > 0)  display |= mask;   // pixel on -> or in mask
-    else display &= ~mask;           //    pixel off -> and with inverted mask
-    SetAddress(page, lAddr, hAddr); // Set the address (sets the page,
-    // lower and higher column address pointers)
-    DeviceWrite(display);             // restore the byte with manipulated bit
-    DisplayDisable();
+    if (x < 0 || x >= DISP_HOR_RESOLUTION || y < 0 || y >= DISP_VER_RESOLUTION)
+        return;
+    uint8_t page = y >> 3;
+    uint8_t mask = 1 << (y & 7);
+    uint8_t old = frameBuffer[page][x];
+    uint8_t display = (_color > 0)? (old | mask): (old & ~mask);
+    if (display != old) {
+        frameBuffer[page][x] = display;
+        MarkDirty(page, x);
+    }
 }
 
 // return pixel color at x,y position
 uint8_t GetPixel(int16_t x, int16_t y) {
-    uint8_t page, add, lAddr, hAddr, mask, temp, display;
-    AssignPageAddress(y);
-    add = x + OFFSET;
-    lAddr = 0x0F & add; hAddr = 0x10 | (add >> 4); // low + high address
-    // Calculate mask from rows basically do a y%8 and remainder is bit position
-    temp = y >> 3;                  // Divide by 8
-    temp <<= 3;                     // Multiply by 8
-    temp = y - temp;                // Calculate bit position
-    mask = 1 << temp;               // Left shift 1 by bit position
-    DisplayEnable();
-    SetAddress(page, lAddr, hAddr); // set page, lower, higher column address
-    display = SingleDeviceRead();	// Read to initiate Read transaction on PMP
-    display = DeviceRead();         // Read data from display buffer
-    DisplayDisable();
-    return (display & mask);        // mask all other bits and return the result
+    if (x < 0 || x >= DISP_HOR_RESOLUTION || y < 0 || y >= DISP_VER_RESOLUTION)
+        return 0;
+    return frameBuffer[y >> 3][x] & (1 << (y & 7));
 }
 
 // clears screen with _color
 void ClearDevice(void) {
-    DisplayEnable();
-    for(uint8_t i = 0xB0; i < 0xB8; i++) {  // go through all 8 pages
-        SetAddress(i, 0x00, 0x10);
-        for(uint8_t j = 0; j < 132; j++) // write to all 132 bytes
-            DeviceWrite(_color);
+    for (uint8_t page = 0; page < 8; page++) {
+        for (uint8_t x = 0; x < DISP_HOR_RESOLUTION; x++) {
+            frameBuffer[page][x] = _color;
+        }
+        dirtyMin[page] = 0;
+        dirtyMax[page] = DISP_HOR_RESOLUTION - 1;
+    }
+}
+
+// send the dirty pages, profiled on its own so that the many flushes with
+// nothing to send don't hide the cost of the real ones
+static void DisplaySend(void) {
+    PROFILE_SCOPE(PROF_DISPLAY_FLUSH);
+    uint8_t add;
+    ClockBoost();  // send at full speed
+    for (uint8_t page = 0; page < 8; page++) {
+        if (dirtyMax[page] < dirtyMin[page]) continue;
+        add = dirtyMin[page] + OFFSET;
+        DisplayEnable();
+        SetAddress(0xB0 + page, 0x0F & add, 0x10 | (add >> 4));
+        for (uint8_t x = dirtyMin[page]; x <= dirtyMax[page]; x++) {
+            DeviceWrite(frameBuffer[page][x]);
+        }
+        DisplayDisable();
+        dirtyMin[page] = 1;  // clean
+        dirtyMax[page] = 0;
+    }
+    displayShown = 1;  // DisplayStart() made the first send a full frame
+    ClockRelease();
+}
+
+// write the changed columns of the frame buffer to the display
+void DisplayFlush(void) {
+    if (!displayReady) return;  // panel still powering up
+    for (uint8_t page = 0; page < 8; page++) {
+        if (dirtyMax[page] >= dirtyMin[page]) {
+            DisplaySend();
+            return;
+        }
     }
-    DisplayDisable();
+}
+
+// set the contrast (brightness), 0 ~ 255
+void DisplaySetContrast(uint8_t contrast) {
+    DisplayEnable();
+    DisplaySetCommand();
+    DeviceWrite(0x81);
+    DeviceWrite(contrast);
+    DisplayDisable(); DisplaySetData();
 }
 
 // Simple 5x7 font for ASCII characters 32-126
@@ -302,6 +384,7 @@ void DrawChar(int16_t x, int16_t y, char c) {
 
 // Draw a string at position (x, y)
 void DrawString(int16_t x, int16_t y, const char* str) {
+    PROFILE_SCOPE(PROF_DRAW_STRING);
     int16_t cursorX = x;
     while (*str) {
         DrawChar(cursorX, y, *str);
@@ -14,8 +14,6 @@
 
 #include <xc.h>
 
-#define CLOCK_FREQ 12000000
-
 #define DISP_HOR_RESOLUTION 128
 #define DISP_VER_RESOLUTION 64
 #define DISP_ORIENTATION    0
@@ -36,6 +34,11 @@
 #define DisplayDisable()        LATDbits.LATD11 = 1
 #define OFFSET  2  // display offset in x direction
 
+#define DISPLAY_POWERUP_MS  150  // DC-DC on to DisplayStart()
+
+#define CONTRAST_NORMAL 0x60
+#define CONTRAST_DIM    0x08
+
 #define BLACK (uint16_t)0b00000000
 #define WHITE (uint16_t)0b11111111
 
@@ -45,8 +48,17 @@ extern uint8_t _color;
 void Delay10us( uint32_t tenMicroSecondCounter );
 void DelayMs( uint16_t ms );
 
-void ResetDevice(void);
+// initialization: DisplayPowerUp(), DISPLAY_POWERUP_MS of other work,
+// DisplayStart(); the next DisplayFlush() sends the whole frame buffer
+void DisplayPowerUp(void);
+void DisplayStart(void);
+uint8_t DisplayReady(void);
+uint8_t DisplayShown(void);  // 1 once that first flush is done
+// drawing functions work on a RAM frame buffer, DisplayFlush() sends the
+// changes to the display
 void ClearDevice(void);
+void DisplayFlush(void);
+void DisplaySetContrast(uint8_t contrast);
 void PutPixel(int16_t x, int16_t y);
 uint8_t GetPixel(int16_t x, int16_t y);
 void DrawChar(int16_t x, int16_t y, char c);
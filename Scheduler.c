@@ -0,0 +1,102 @@
+/*
+ * Cooperative Scheduler
+ * 
+ * A pass walks the task table in order and runs every task that is due.
+ * A task that blocks (a UI flow waiting for a touch, say) calls 
+ * SchedulerYield(), which runs one pass over the other tasks; a task that
+ * is already running is skipped, so nothing is re-entered.
+ */
+#include "Scheduler.h"
+#include "SysTick.h"
+#include "Power.h"
+#include "Supervisor.h"
+
+SchedulerStats schedStats;
+
+Task* tasks;
+uint8_t taskCount;
+uint8_t yieldDepth;
+uint32_t nestedUs;  // time spent in nested tasks during the current task
+
+void SchedulerInit(Task* taskTable, uint8_t count) {
+    tasks = taskTable;
+    taskCount = count;
+    yieldDepth = 0;
+    nestedUs = 0;
+    uint32_t now = millis();
+    for (uint8_t i = 0; i < count; i++) {
+        tasks[i].lastStart = now - tasks[i].periodMs;  // due right away
+        tasks[i].runs = tasks[i].totalUs = 0;
+        tasks[i].maxUs = tasks[i].overruns = tasks[i].maxLateMs = 0;
+        tasks[i].running = 0;
+    }
+    schedStats.passes = schedStats.idlePasses = 0;
+    schedStats.maxReady = schedStats.maxDepth = 0;
+}
+
+// run one task and account its own run time (nested tasks excluded)
+static void RunTask(Task* t, uint32_t now) {
+    uint32_t late = now - t->lastStart - t->periodMs;
+    if (t->runs > 0 && late > t->maxLateMs) {
+        t->maxLateMs = (late > 0xFFFF)? 0xFFFF: (uint16_t)late;
+    }
+    t->lastStart = now;
+    t->running = 1;
+    uint8_t outerTask = SupervisorSetTask((uint8_t)(t - tasks));
+
+    uint32_t outerNested = nestedUs;
+    nestedUs = 0;
+    uint32_t start = micros();
+    t->run();
+    uint32_t elapsed = micros() - start;
+    uint32_t own = elapsed - nestedUs;
+    nestedUs = outerNested + elapsed;  // hide all of it from the caller
+
+    SupervisorSetTask(outerTask);
+    t->running = 0;
+    t->runs++;
+    t->totalUs += own;
+    if (own > t->maxUs) t->maxUs = (own > 0xFFFF)? 0xFFFF: (uint16_t)own;
+    if (own > t->budgetUs) t->overruns++;
+}
+
+// one pass over the task table, returns the number of tasks that ran
+static uint8_t SchedulerPass(void) {
+    uint8_t ready = 0;
+    for (uint8_t i = 0; i < taskCount; i++) {
+        Task* t = &tasks[i];
+        uint32_t now = millis();
+        if (t->running || !TIME_ELAPSED(t->lastStart, t->periodMs)) continue;
+        ready++;
+        RunTask(t, now);
+    }
+    SupervisorKick();  // the watchdog only fires if a task stops returning
+    schedStats.passes++;
+    if (ready == 0) schedStats.idlePasses++;
+    if (ready > schedStats.maxReady) schedStats.maxReady = ready;
+    return ready;
+}
+
+void SchedulerRun(void) {
+    while (1) {
+        if (SchedulerPass() == 0) {
+            PowerIdle();  // nothing due, sleep until the next interrupt
+        }
+    }
+}
+
+void SchedulerYield(void) {
+    if (taskCount == 0) return;  // not started yet
+    yieldDepth++;
+    if (yieldDepth > schedStats.maxDepth) schedStats.maxDepth = yieldDepth;
+    SchedulerPass();
+    yieldDepth--;
+}
+
+Task* SchedulerTask(uint8_t index) {
+    return &tasks[index];
+}
+
+uint8_t SchedulerTaskCount(void) {
+    return taskCount;
+}
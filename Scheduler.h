@@ -0,0 +1,44 @@
+/*
+ * Cooperative Scheduler - Header
+ * 
+ * Runs a fixed table of tasks round-robin. Each task runs to completion,
+ * at most once per period, and is timed against its budget. Long blocking
+ * code keeps the other tasks alive by calling SchedulerYield() while it 
+ * waits (delay() does this). Every pass clears the watchdog (Supervisor.h).
+ */
+#ifndef SCHEDULER__H
+#define	SCHEDULER__H
+
+#include <xc.h>
+
+typedef struct {
+    const char* name;
+    void (*run)(void);
+    uint16_t periodMs;   // minimum time between starts, 0 = every pass
+    uint16_t budgetUs;   // runs longer than this count as overruns
+    // statistics, maintained by the scheduler
+    uint32_t lastStart;  // millis() of the last start
+    uint32_t runs;
+    uint32_t totalUs;    // run time, excluding tasks run by its yields
+    uint16_t maxUs;
+    uint16_t overruns;
+    uint16_t maxLateMs;  // longest wait past the due time
+    uint8_t  running;    // 1 while inside run() (possibly yielding)
+} Task;
+
+typedef struct {
+    uint32_t passes;     // scheduler passes
+    uint32_t idlePasses; // passes with no task due
+    uint8_t  maxReady;   // most tasks due in a single pass
+    uint8_t  maxDepth;   // deepest SchedulerYield() nesting
+} SchedulerStats;
+
+extern SchedulerStats schedStats;
+
+void SchedulerInit(Task* taskTable, uint8_t count);
+void SchedulerRun(void);      // never returns, idles when nothing is due
+void SchedulerYield(void);    // run the due tasks once from a waiting task
+Task* SchedulerTask(uint8_t index);
+uint8_t SchedulerTaskCount(void);
+
+#endif	/* SCHEDULER__H */
@@ -0,0 +1,121 @@
+/*
+ * Software Timers
+ *
+ * Three wheels of 64 slots: level 0 has a slot per millisecond, level 1 a
+ * slot per 64 ms and level 2 a slot per 4096 ms. A timer goes into the
+ * level whose range covers its remaining time. Every 64 ticks the next
+ * level 1 slot is re-filed into level 0 (and every 4096 ticks a level 2
+ * slot into level 1), so a timer is touched at most once per level before
+ * it fires.
+ */
+#include "SoftTimer.h"
+#include "SysTick.h"
+
+SoftTimer* wheel[WHEEL_LEVELS][WHEEL_SIZE];
+uint32_t wheelTime;  // last tick processed
+
+void TimerInit(void) {
+    for (uint8_t level = 0; level < WHEEL_LEVELS; level++) {
+        for (uint8_t i = 0; i < WHEEL_SIZE; i++) {
+            wheel[level][i] = 0;
+        }
+    }
+    wheelTime = millis();
+}
+
+// put t into the slot for its expiry time
+static void WheelAdd(SoftTimer* t) {
+    uint32_t delta = t->expires - wheelTime;
+    uint32_t expires = t->expires;
+    SoftTimer** slot;
+
+    if (delta >= WHEEL_RANGE) {
+        expires = wheelTime + WHEEL_RANGE - 1;  // park, re-filed later
+    }
+    if (delta < WHEEL_SIZE) {
+        slot = &wheel[0][expires & WHEEL_MASK];
+    } else if (delta < (1UL << (2 * WHEEL_BITS))) {
+        slot = &wheel[1][(expires >> WHEEL_BITS) & WHEEL_MASK];
+    } else {
+        slot = &wheel[2][(expires >> (2 * WHEEL_BITS)) & WHEEL_MASK];
+    }
+
+    t->next = *slot;
+    if (t->next) t->next->pprev = &t->next;
+    t->pprev = slot;
+    *slot = t;
+}
+
+static void WheelRemove(SoftTimer* t) {
+    *t->pprev = t->next;
+    if (t->next) t->next->pprev = t->pprev;
+    t->pprev = 0;
+}
+
+void TimerStart(SoftTimer* t, uint32_t delayMs, uint32_t periodMs,
+                TimerCallback callback) {
+    if (t->pprev) WheelRemove(t);
+    if (delayMs == 0) delayMs = 1;  // next tick at the earliest
+    t->expires = millis() + delayMs;
+    t->periodMs = periodMs;
+    t->callback = callback;
+    WheelAdd(t);
+}
+
+void TimerStop(SoftTimer* t) {
+    if (t->pprev) WheelRemove(t);
+}
+
+uint8_t TimerActive(SoftTimer* t) {
+    return t->pprev != 0;
+}
+
+// move all timers of a slot to the list 'pending' so they can be
+// re-filed or fired; callbacks may stop any timer while this runs
+static SoftTimer* TakeSlot(SoftTimer** slot, SoftTimer** pending) {
+    *pending = *slot;
+    *slot = 0;
+    if (*pending) (*pending)->pprev = pending;
+    return *pending;
+}
+
+static void Cascade(uint8_t level) {
+    SoftTimer* pending;
+    uint8_t index = (wheelTime >> (level * WHEEL_BITS)) & WHEEL_MASK;
+    TakeSlot(&wheel[level][index], &pending);
+    while (pending) {
+        SoftTimer* t = pending;
+        WheelRemove(t);
+        WheelAdd(t);
+    }
+}
+
+void TimerTask(void) {
+    uint32_t now = millis();
+    while (wheelTime != now) {
+        wheelTime++;
+        // re-file the coarser slots that start at this tick first
+        if ((wheelTime & WHEEL_MASK) == 0) {
+            Cascade(1);
+            if (((wheelTime >> WHEEL_BITS) & WHEEL_MASK) == 0) {
+                Cascade(2);
+            }
+        }
+
+        SoftTimer* pending;
+        TakeSlot(&wheel[0][wheelTime & WHEEL_MASK], &pending);
+        while (pending) {
+            SoftTimer* t = pending;
+            WheelRemove(t);
+            if (t->expires != wheelTime) {
+                WheelAdd(t);  // parked long timer, not due yet
+                continue;
+            }
+            if (t->periodMs) {
+                t->expires += t->periodMs;
+                WheelAdd(t);
+            }
+            t->callback(t);  // may restart or stop t
+        }
+    }
+}
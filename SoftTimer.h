@@ -0,0 +1,45 @@
+/*
+ * Software Timers - Header
+ *
+ * One-shot and periodic timers with callbacks on a hierarchical timer
+ * wheel driven by the system tick. Starting, stopping and expiring a timer
+ * is O(1) no matter how many timers are running. Callbacks run from
+ * TimerTask(), i.e. in task context, not in an interrupt.
+ *
+ * The SoftTimer structs belong to the caller (static storage) and must
+ * stay valid while the timer runs.
+ */
+#ifndef SOFTTIMER__H
+#define	SOFTTIMER__H
+
+#include <xc.h>
+
+#define WHEEL_BITS      6                   // slots per level = 64
+#define WHEEL_LEVELS    3                   // 1 ms, 64 ms, 4.096 s slots
+#define WHEEL_SIZE      (1 << WHEEL_BITS)
+#define WHEEL_MASK      (WHEEL_SIZE - 1)
+#define WHEEL_RANGE     (1UL << (WHEEL_BITS * WHEEL_LEVELS))  // 262 s
+// longer timeouts are parked in the last slot and re-filed when it comes up
+
+typedef struct SoftTimer SoftTimer;
+typedef void (*TimerCallback)(SoftTimer* t);
+
+struct SoftTimer {
+    SoftTimer* next;        // slot list, managed by the wheel
+    SoftTimer** pprev;      // link pointing at this timer, NULL = stopped
+    uint32_t expires;       // tick the timer is due
+    uint32_t periodMs;      // 0 = one-shot
+    TimerCallback callback;
+};
+
+void TimerInit(void);
+// (re)start t to call back after delayMs, then every periodMs if not 0
+void TimerStart(SoftTimer* t, uint32_t delayMs, uint32_t periodMs,
+                TimerCallback callback);
+void TimerStop(SoftTimer* t);
+uint8_t TimerActive(SoftTimer* t);
+
+// advances the wheel to millis() and runs the callbacks that are due
+void TimerTask(void);
+
+#endif	/* SOFTTIMER__H */
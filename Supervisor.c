@@ -0,0 +1,79 @@
+/*
+ * Supervisor
+ *
+ * RCON tells why the device restarted. A watchdog reset is charged to the
+ * task and wait site that were recorded when it hit; a controlled reset
+ * is logged by SupervisorFault() itself before the RESET instruction.
+ */
+#include "Supervisor.h"
+
+#define SUPERVISOR_MAGIC    0x5A3C
+
+// not cleared by the startup code
+SupervisorLog supervisorLog __attribute__((persistent));
+
+uint8_t coldStart;  // last reset was power-on or brown-out
+
+const char* const supervisorSiteNames[SUPERVISOR_SITES] = {
+    "-", "ADC", "NVM", "PMP",
+};
+
+void SupervisorInit(void) {
+    SupervisorLog* l = &supervisorLog;
+
+    coldStart = RCONbits.POR || RCONbits.BOR;
+    if (coldStart || l->magic != SUPERVISOR_MAGIC) {
+        // RAM contents are undefined after power-on
+        l->resets = l->watchdogResets = l->waitResets = 0;
+        for (uint8_t i = 0; i < SUPERVISOR_SITES; i++) {
+            l->siteOverruns[i] = 0;
+        }
+        l->lastCause = SUPERVISOR_CAUSE_NONE;
+        l->lastSite = SUPERVISOR_SITE_NONE;
+        l->lastTask = SUPERVISOR_NO_TASK;
+        l->magic = SUPERVISOR_MAGIC;
+    } else {
+        l->resets++;
+        if (RCONbits.WDTO) {
+            l->watchdogResets++;
+            if (l->site != SUPERVISOR_SITE_NONE) l->siteOverruns[l->site]++;
+            l->lastCause = SUPERVISOR_CAUSE_WATCHDOG;
+            l->lastSite = l->site;
+            l->lastTask = l->task;
+        }
+    }
+    RCONbits.POR = 0;
+    RCONbits.BOR = 0;
+    RCONbits.WDTO = 0;
+    RCONbits.SWR = 0;
+
+    l->site = SUPERVISOR_SITE_NONE;
+    l->task = SUPERVISOR_NO_TASK;
+    ClrWdt();
+    RCONbits.SWDTEN = 1;
+}
+
+uint8_t SupervisorColdStart(void) {
+    return coldStart;
+}
+
+void SupervisorKick(void) {
+    ClrWdt();
+}
+
+uint8_t SupervisorSetTask(uint8_t task) {
+    uint8_t previous = supervisorLog.task;
+    supervisorLog.task = task;
+    return previous;
+}
+
+void SupervisorFault(uint8_t site) {
+    SupervisorLog* l = &supervisorLog;
+    l->siteOverruns[site]++;
+    l->waitResets++;
+    l->lastCause = SUPERVISOR_CAUSE_WAIT;
+    l->lastSite = site;
+    l->lastTask = l->task;
+    asm volatile ("reset");
+    while (1);
+}
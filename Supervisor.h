@@ -0,0 +1,94 @@
+/*
+ * Supervisor - Header
+ *
+ * Keeps the kiosk from freezing in a hung task or a peripheral that never
+ * finishes. The watchdog (about 1 s, see the configuration bits) is
+ * cleared by every scheduler pass, so a task that stops returning resets
+ * the device. Busy-waits on hardware flags go through SUPERVISED_WAIT()
+ * with a time budget; an overrun is logged with its site and the device
+ * is reset in a controlled way.
+ *
+ *   SUPERVISED_WAIT(!IFS0bits.AD1IF, SUPERVISOR_SITE_ADC, ADC_WAIT_US);
+ *
+ * The log lives in RAM that the startup code does not clear, so the
+ * counters survive every reset except power-on and brown-out.
+ */
+#ifndef SUPERVISOR__H
+#define	SUPERVISOR__H
+
+#include <xc.h>
+#include "SysTick.h"
+
+// wait sites, where a controlled reset can come from
+#define SUPERVISOR_SITE_NONE    0   // not in a supervised wait
+#define SUPERVISOR_SITE_ADC     1   // ADC conversion (touch scan)
+#define SUPERVISOR_SITE_NVM     2   // flash erase/write
+#define SUPERVISOR_SITE_PMP     3   // display bus cycle
+#define SUPERVISOR_SITES        4
+
+#define SUPERVISOR_NO_TASK      0xFF    // outside the scheduler (boot)
+
+// cause of the last supervisor reset
+#define SUPERVISOR_CAUSE_NONE       0
+#define SUPERVISOR_CAUSE_WATCHDOG   1
+#define SUPERVISOR_CAUSE_WAIT       2
+
+typedef struct {
+    uint16_t magic;             // SUPERVISOR_MAGIC once initialized
+    uint16_t resets;            // resets since power-on, of any kind
+    uint16_t watchdogResets;
+    uint16_t waitResets;        // controlled resets after a wait overrun
+    uint16_t siteOverruns[SUPERVISOR_SITES];
+    uint8_t  lastCause;
+    uint8_t  lastSite;          // site and task of the last supervisor reset
+    uint8_t  lastTask;
+    uint8_t  site;              // current wait site
+    uint8_t  task;              // running task, index in the task table
+} SupervisorLog;
+
+extern SupervisorLog supervisorLog;
+extern const char* const supervisorSiteNames[SUPERVISOR_SITES];
+
+// waits while cond holds; the time is only taken once the first check
+// fails, so a flag that is already clear costs one test
+#define SUPERVISED_WAIT(cond, waitSite, budgetUs) do {                    \
+        if (cond) {                                                       \
+            uint32_t supStart = micros();                                 \
+            supervisorLog.site = (waitSite);                              \
+            while (cond) {                                                \
+                if (micros() - supStart > (budgetUs)) {                   \
+                    SupervisorFault(waitSite);                            \
+                }                                                         \
+            }                                                             \
+            supervisorLog.site = SUPERVISOR_SITE_NONE;                    \
+        }                                                                 \
+    } while (0)
+
+// the same bounded by loop iterations instead of micros(), for waits of a
+// few cycles done thousands of times in a row, where reading the time would
+// cost more than the wait; loops counts iterations of the poll, several
+// instruction cycles each, so the bound scales with Fcy like the
+// peripherals clocked from it
+#define SUPERVISED_WAIT_LOOPS(cond, waitSite, loops) do {                 \
+        uint16_t supLoops = (loops);                                      \
+        while (cond) {                                                    \
+            if (--supLoops == 0) SupervisorFault(waitSite);               \
+        }                                                                 \
+    } while (0)
+
+// reads the reset cause into the log and enables the watchdog
+void SupervisorInit(void);
+
+// 1 if the last reset was power-on or brown-out, RAM contents are lost
+uint8_t SupervisorColdStart(void);
+
+// clears the watchdog, called once per scheduler pass
+void SupervisorKick(void);
+
+// records the running task for the log, returns the previous one
+uint8_t SupervisorSetTask(uint8_t task);
+
+// logs a wait overrun at site and resets the device
+void SupervisorFault(uint8_t site) __attribute__((noreturn));
+
+#endif	/* SUPERVISOR__H */
@@ -0,0 +1,59 @@
+/*
+ * System Tick
+ * 
+ * Timer1 runs with a 1 ms period and counts milliseconds in its interrupt.
+ * micros() adds the Timer1 count within the current millisecond.
+ */
+#include "SysTick.h"
+#include "Clock.h"
+
+volatile uint32_t tickMs;  // incremented every millisecond by the interrupt
+
+// Timer1 prescaler for the new Fcy, clock listener. Changing it loses the
+// partial prescaler count, less than one 4 us timer step.
+static void TickClockChanged(uint32_t fcy) {
+    uint16_t prescale = (uint16_t)(fcy / TICK_TIMER_HZ);
+    if (prescale >= 256) T1CONbits.TCKPS = 0b11;
+    else if (prescale >= 64) T1CONbits.TCKPS = 0b10;
+    else if (prescale >= 8) T1CONbits.TCKPS = 0b01;
+    else T1CONbits.TCKPS = 0b00;
+}
+
+void TickInit() {
+    T1CON = 0x0000;
+    TickClockChanged(ClockFcy());
+    ClockAddListener(TickClockChanged);
+    PR1 = TICK_PERIOD; TMR1 = 0;
+    tickMs = 0;
+    IPC0bits.T1IP = TICK_IPL;
+    IFS0bits.T1IF = 0;
+    IEC0bits.T1IE = 1;
+    T1CONbits.TON = 1;  // Turn on Timer1
+}
+
+void __attribute__((__interrupt__, no_auto_psv)) _T1Interrupt(void) {
+    tickMs++;
+    IFS0bits.T1IF = 0;
+}
+
+// 32 bit read of the tick counter, repeated if the interrupt hit in between
+uint32_t millis() {
+    uint32_t ms;
+    do {
+        ms = tickMs;
+    } while (ms != tickMs);
+    return ms;
+}
+
+uint32_t micros() {
+    uint32_t ms, check;
+    uint16_t count;
+    do {
+        ms = tickMs;
+        count = TMR1;
+        check = tickMs;
+    } while (ms != check);  // tick interrupt in between: read again
+    // period is over but the interrupt is still pending (e.g. IPL raised)
+    if (IFS0bits.T1IF && count < (PR1 >> 1)) ms++;
+    return ms * 1000 + (uint32_t)count * 1000 / ((uint32_t)PR1 + 1);
+}
@@ -0,0 +1,32 @@
+/*
+ * System Tick - Header
+ * 
+ * Monotonic 1 ms system tick from the Timer1 interrupt. millis() and 
+ * micros() share the same clock, so timing measurements, timeouts and
+ * animations all agree with each other.
+ */
+#ifndef SYSTICK__H
+#define	SYSTICK__H
+
+#include <xc.h>
+
+// Timer1 counts at the same rate at both clock speeds: the prescaler is
+// 1:64 at Fcy 16 MHz and 1:8 at Fcy 2 MHz (see Clock.h)
+#define TICK_TIMER_HZ   250000UL
+#define TICK_PERIOD     (TICK_TIMER_HZ / 1000 - 1)  // PR1 for 1 ms
+#define TICK_IPL        4           // Timer1 interrupt priority
+
+// Overflow-safe time comparisons for millis()/micros() values
+#define TIME_AFTER(a, b)         ((int32_t)((uint32_t)(a) - (uint32_t)(b)) >= 0)
+#define TIME_ELAPSED(start, ms)  ((uint32_t)(millis() - (start)) >= (uint32_t)(ms))
+
+// starts Timer1 and its 1 ms interrupt
+void TickInit();
+
+// milliseconds since TickInit(), wraps after ~49 days
+uint32_t millis();
+
+// microseconds since TickInit() in 4 us steps, wraps after ~71 minutes
+uint32_t micros();
+
+#endif	/* SYSTICK__H */
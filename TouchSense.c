@@ -10,6 +10,11 @@
  * Original driver by: kvl@eti.uni-siegen.de
  */
 #include "TouchSense.h"
+#include "SysTick.h"
+#include "Profile.h"
+#include "Clock.h"
+#include "Supervisor.h"
+#include "IrqMask.h"
 
 // CTMU Constants
 #define CTMU_OFF                        0x0000
@@ -31,6 +36,41 @@
 
 #define AVG_DELAY                       64 //1 
 #define CHARGE_TIME_COUNT               90 //34 // If optimized, change value
+// The charge pulse is timed by a counted loop. CHARGE_LOOP_CYCLES in
+// TouchSense.h is its cost at the project's -O0, checked by
+// MeasureChargeLoop() at init.
+#define CHARGE_DELAY()  { for (uint8_t j = 0; j < CHARGE_TIME_COUNT; j++); }
+#define WARMUP_READINGS                 160  // pad readings before detection
+
+// charge pulse with interrupts masked: the loop plus the edge setup
+#define CHARGE_PULSE_CYCLES(loopCycles) \
+    ((uint32_t)CHARGE_TIME_COUNT * (loopCycles) + 40)
+IRQ_MASK_STATIC_BOUND(CTMU, CHARGE_PULSE_CYCLES(CHARGE_LOOP_CYCLES));
+#define SCAN_BUDGET                     NUM_TOUCHPADS // measurements per scan
+
+// Drift compensation with the reference channel
+#define REF_RETRIM_SHIFT                4    // retrim beyond 1/16 (~6%) drift
+#define REF_RETRIM_HOLDOFF              200  // scans between trim steps
+#define ITRIM_MAX                       31   // +/-62% in 2% steps
+
+// Pad health monitor
+#define HEALTH_WINDOW                   0xFF // readings per dead check (mask)
+#define HEALTH_PROBE_WINDOW             0x1F // same while the pad is faulted
+#define HEALTH_PROBE_MASK               0x0F // faulted pads read 1 scan in 16
+#define HEALTH_DEAD_SPAN                0    // max ADC spread of a dead pad
+#define HEALTH_RAIL_LOW                 4    // ADC readings pinned to a rail
+#define HEALTH_RAIL_HIGH                1019
+#define HEALTH_STUCK_READINGS           2000 // ~20 s touched at 10 ms/scan
+
+// Swipe crossover: signal ratio of next pad vs current pad, 0..256
+#define SWIPE_RATIO_LOW                 64   // 25%, finger still on old pad
+#define SWIPE_RATIO_HIGH                192  // 75%, finger mostly on new pad
+#define SWIPE_NO_PAD                    0xFF
+
+#define ADC_FULL_SCALE                  1023 // 10 bit conversion result
+
+// Wait budget for one ADC conversion, ~110 us at 2 MHz Fcy
+#define ADC_WAIT_US                     1000
 
 uint8_t buttons[NUM_TOUCHPADS];
 uint16_t _potADC;
@@ -40,11 +80,46 @@ uint16_t rawCTMU[NUM_TOUCHPADS];   // raw AD value
 uint16_t average[NUM_TOUCHPADS];   // averaged AD value
 uint16_t trip   [NUM_TOUCHPADS];   // trip point for touch pad
 uint16_t hyst   [NUM_TOUCHPADS];   // hysteresis for touch pad
-uint8_t first;          // first variable to 'discard' first N samples
+uint8_t first;          // warm-up readings left, every slot counts one
 uint8_t buttonInd;      // index of touch pad being checked
+uint8_t backgroundInd;  // same, for pads outside the focus set
+uint8_t focusMask;      // pads scanned more often, see TouchSetFocus()
 uint16_t value, bigVal, smallAvg;  // button's value, bigval, smallavg
 uint16_t AvgIndex;
 
+uint16_t refAvg;         // reference reading, averaged (x16)
+uint16_t refTarget;      // refAvg at the end of warm-up (x16)
+uint8_t  refReseed;      // restart refAvg after a trim step
+uint8_t  refHoldoff;     // scans until the next trim step is allowed
+int8_t   ctmuTrim;       // current ITRIM setting, signed
+
+TouchEvent touchEvents[TOUCH_EVENT_QUEUE];  // ring buffer, oldest dropped
+uint8_t touchEventHead, touchEventTail;
+
+// gesture recognizer state between GestureUpdate() calls
+uint8_t  gesturePad;         // pad currently held, SWIPE_NO_PAD if none
+uint8_t  gestureLongSent;    // long press already reported for this hold
+uint16_t gesturePress;       // time the held pad was pressed
+uint16_t gestureNextRepeat;  // time of the next repeat
+uint16_t gestureInterval;    // current repeat interval
+uint8_t  lastTapPad;         // pad and release time of the last tap
+uint16_t lastTapTime;
+
+uint8_t  padHealth[NUM_TOUCHPADS];      // PAD_OK, PAD_STUCK or PAD_DEAD
+uint8_t  padTouched[NUM_TOUCHPADS];     // hysteresis state, before health
+uint16_t healthMin[NUM_TOUCHPADS];      // ADC range seen in current window
+uint16_t healthMax[NUM_TOUCHPADS];
+uint8_t  healthCount[NUM_TOUCHPADS];    // readings in current window
+uint16_t pressedReadings[NUM_TOUCHPADS];// consecutive touched readings
+uint8_t  scanCount;                     // ReadCTMU() calls, for probing
+uint8_t  chargeLoopCycles;              // measured cost of CHARGE_DELAY()
+
+SwipeTrace swipe;
+// swipe tracking state between SwipeUpdate() calls
+uint16_t swipeEnter, swipeLeave;  // entry time / last time on current pad
+uint8_t  crossPad;                // pad whose crossover is being timed
+uint16_t crossLow, crossTime;     // time ratio was last low, measured crossing
+
 // read potentiometer and store value in global variable
 void ReadPotentiometer() {
     AD1CON1 = 0x00E4;   // Off, Auto sample start, auto-convert
@@ -53,15 +128,61 @@ void ReadPotentiometer() {
     AD1CHS  = 0x0;      // MUXA uses AN0
     AD1CSSL = 0;        // No scanned inputs
     AD1CON1bits.ADON = 1;        // turn on ADC module
-    while(!AD1CON1bits.DONE);    // wait for conversion to complete
+    // wait for conversion to complete
+    SUPERVISED_WAIT(!AD1CON1bits.DONE, SUPERVISOR_SITE_ADC, ADC_WAIT_US);
     _potADC = ADC1BUF0;
     AD1CON1bits.ADON = 0;        // turn off ADC module
 }
 
+// queue a pad state change, dropping the oldest event when full
+static void TouchPushEvent(uint8_t pad, uint8_t pressed, uint32_t time) {
+    TouchEvent* e = &touchEvents[touchEventHead];
+    e->time = time; e->pad = pad; e->pressed = pressed;
+    touchEventHead = (touchEventHead + 1) & (TOUCH_EVENT_QUEUE - 1);
+    if (touchEventHead == touchEventTail) {
+        touchEventTail = (touchEventTail + 1) & (TOUCH_EVENT_QUEUE - 1);
+    }
+}
+
+// take the oldest touch event, returns 0 if there is none
+uint8_t TouchGetEvent(TouchEvent* e) {
+    if (touchEventHead == touchEventTail) return 0;
+    *e = touchEvents[touchEventTail];
+    touchEventTail = (touchEventTail + 1) & (TOUCH_EVENT_QUEUE - 1);
+    return 1;
+}
+
+void TouchFlushEvents() {
+    touchEventTail = touchEventHead;
+}
+
+// Cost of one charge delay iteration as compiled, in CLOCK_HIGH cycles,
+// rounded up. The cost of the counter reads is measured and taken off.
+static void MeasureChargeLoop(void) {
+    uint16_t current_ipl;
+    SET_AND_SAVE_CPU_IPL(current_ipl, 7);  // no interrupt in the sample
+    uint32_t start = ProfileCycles();
+    uint32_t reads = ProfileCycles() - start;
+    start = ProfileCycles();
+    CHARGE_DELAY();
+    uint32_t loop = ProfileCycles() - start - reads;
+    RESTORE_CPU_IPL(current_ipl);
+    chargeLoopCycles = (loop + CHARGE_TIME_COUNT - 1) / CHARGE_TIME_COUNT;
+
+    // a slower loop than assumed makes the static CTMU bound untrue
+    if (chargeLoopCycles > CHARGE_LOOP_CYCLES) {
+        IrqMaskBoundFailed(IRQ_SITE_CTMU, CHARGE_PULSE_CYCLES(chargeLoopCycles));
+    }
+}
+
+uint8_t TouchChargeLoopCycles(void) {
+    return chargeLoopCycles;
+}
+
 // routine to set up CTMU for capacitive touch sensing
 void CTMUInit( void ) {
-    TRISB    = 0x1F01;   //RB0, RB8, RB9, RB10, RB11, RB12 in tri-state
-    AD1PCFGL &= ~0x1F01;
+    TRISB    = 0x3F01;   //RB0, RB8 - RB13 in tri-state (RB13 = reference)
+    AD1PCFGL &= ~0x3F01;
         CTMUCON = CTMU_OFF | CTMU_CONTINUE_IN_IDLE | CTMU_EDGE_DELAY_DISABLED |
               CTMU_EDGES_BLOCKED | CTMU_NO_EDGE_SEQUENCE |
               CTMU_CURRENT_NOT_GROUNDED | CTMU_TRIGGER_OUT_DISABLED |
@@ -80,97 +201,431 @@ void CTMUInit( void ) {
     CTMUCONbits.CTMUEN = 1;           // enable CTMU
     for (uint8_t i = 0; i < NUM_TOUCHPADS; i++ ) {
         trip[i] = TRIP_VALUE; hyst[i] = HYSTERESIS_VALUE;
+        padHealth[i] = PAD_OK;
+        healthMin[i] = 0xFFFF; healthMax[i] = 0; healthCount[i] = 0;
+        pressedReadings[i] = 0; padTouched[i] = 0;
+    }
+    ctmuTrim = 0;
+    refReseed = 1; refHoldoff = 0;
+    GestureReset();
+    touchEventHead = touchEventTail = 0;
+    buttonInd = backgroundInd = 0;
+    focusMask = 0;
+    first = WARMUP_READINGS;  // 32 scans of SCAN_BUDGET readings
+    MeasureChargeLoop();
+}
+
+// Track signal statistics of a pad after its reading was evaluated and mark
+// it stuck (touched for too long) or dead (frozen reading). A stuck pad 
+// recovers on its first released reading, a dead one when it moves again.
+// Works on padTouched, so forcing buttons[] to 0 does not end a touch, and
+// on the raw ADC reading, before drift normalization.
+static void CheckPadHealth(uint8_t pad, uint16_t raw) {
+    if (padTouched[pad]) {
+        if (pressedReadings[pad] < HEALTH_STUCK_READINGS) pressedReadings[pad]++;
+        if (pressedReadings[pad] == HEALTH_STUCK_READINGS) {
+            padHealth[pad] = PAD_STUCK;
+        }
+    } else {
+        pressedReadings[pad] = 0;
+        if (padHealth[pad] == PAD_STUCK) padHealth[pad] = PAD_OK;
+    }
+    if (padHealth[pad] == PAD_STUCK) buttons[pad] = 0;  // ignore it
+
+    if (raw < healthMin[pad]) healthMin[pad] = raw;
+    if (raw > healthMax[pad]) healthMax[pad] = raw;
+    uint8_t window = (padHealth[pad] == PAD_OK)? HEALTH_WINDOW: 
+                                                  HEALTH_PROBE_WINDOW;
+    if ((++healthCount[pad] & window) == 0) {
+        uint8_t dead = (healthMax[pad] - healthMin[pad] <= HEALTH_DEAD_SPAN) ||
+                       (healthMax[pad] <= HEALTH_RAIL_LOW) ||
+                       (healthMin[pad] >= HEALTH_RAIL_HIGH);
+        if (dead) {
+            padHealth[pad] = PAD_DEAD;
+        } else if (padHealth[pad] == PAD_DEAD) {
+            padHealth[pad] = PAD_OK;
+        }
+        healthCount[pad] = 0;
+        healthMin[pad] = 0xFFFF; healthMax[pad] = 0;
+    }
+    if (padHealth[pad] == PAD_DEAD) buttons[pad] = 0;
+}
+
+// 1 once the power-up warm-up is over and touches are detected
+uint8_t TouchReady() {
+    return first == 0;
+}
+
+// bit n set = pad n is stuck or dead
+uint8_t PadFaultMask() {
+    uint8_t mask = 0;
+    for (uint8_t i = 0; i < NUM_TOUCHPADS; i++) {
+        if (padHealth[i] != PAD_OK) mask |= 1 << i;
+    }
+    return mask;
+}
+
+// Round-robin over the pads in mask (never empty), starting at *cursor
+static uint8_t NextPadIn(uint8_t mask, uint8_t* cursor) {
+    for (uint8_t n = 0; n < NUM_TOUCHPADS; n++) {
+        uint8_t pad = *cursor;
+        if (++*cursor == NUM_TOUCHPADS) *cursor = 0;
+        if (mask & (1 << pad)) return pad;
+    }
+    return 0;
+}
+
+// One CTMU measurement of the given A/D channel: discharge, charge for a 
+// fixed time with interrupts off, convert, then drain the charge again.
+static uint16_t CTMUSample(uint8_t channel) {
+    uint16_t current_ipl;
+    uint32_t masked;
+    uint16_t result;
+    AD1CHS = channel; //select A/D channel
+    IFS0bits.AD1IF = 0;  // ensure touch circuit is discharged
+    AD1CON1bits.DONE = 0;
+    AD1CON1bits.SAMP = 1;        // manually sample
+    // wait for ADC to begin sampling
+    Nop(); Nop(); Nop(); Nop(); Nop(); Nop(); Nop(); Nop();
+    CTMUCONbits.IDISSEN = 1;  // drain any charge on circuit
+    Nop(); Nop(); Nop(); Nop(); Nop();
+    CTMUCONbits.IDISSEN = 0;
+    Nop(); Nop(); Nop(); Nop(); Nop();
+    IFS0bits.AD1IF = 0;
+    AD1CON1bits.SAMP = 0;  // manually start conversion
+    // ADC to drain CTMU charge
+    SUPERVISED_WAIT(!IFS0bits.AD1IF, SUPERVISOR_SITE_ADC, ADC_WAIT_US);
+
+    IRQ_MASK(current_ipl, masked);  // turn off interrupts
+    IFS0bits.AD1IF = 0;
+    AD1CON1bits.SAMP = 1;      // manually start sampling
+    CTMUCONbits.EDG2STAT = 0;  // make sure edge2 is 0
+    CTMUCONbits.EDG1STAT = 1;   // set edge1 - start charge
+    CHARGE_DELAY();  // CTMU charge time delay
+    CTMUCONbits.EDG1STAT = 0;  // Clear edge1 - Stop Charge
+    IRQ_UNMASK(current_ipl, masked, IRQ_SITE_CTMU);  // re-enable interrupts
+
+    IFS0bits.AD1IF = 0;
+    AD1CON1bits.SAMP = 0;
+    // wait for ADC
+    SUPERVISED_WAIT(!IFS0bits.AD1IF, SUPERVISOR_SITE_ADC, ADC_WAIT_US);
+    result = ADC1BUF0;
+    
+    IFS0bits.AD1IF = 0;    // discharge touch circuit
+    AD1CON1bits.SAMP = 1;  // manually start sampling
+
+    // wait for A/D conversion to begin
+    Nop(); Nop(); Nop(); Nop(); Nop(); Nop(); Nop(); Nop();
+    CTMUCONbits.IDISSEN = 1;        // drain any charge on circuit
+    Nop(); Nop(); Nop(); Nop(); Nop(); 
+    CTMUCONbits.IDISSEN = 0;        // end charge drain
+    Nop(); Nop(); Nop(); Nop();
+    IFS0bits.AD1IF = 0;
+    AD1CON1bits.SAMP = 0;    // perform conversion
+    // wait for ADC
+    SUPERVISED_WAIT(!IFS0bits.AD1IF, SUPERVISOR_SITE_ADC, ADC_WAIT_US);
+    IFS0bits.AD1IF = 0;
+    AD1CON1bits.DONE = 0;  // ADC to drain CTMU charge
+    return result;
+}
+
+// Measure the reference channel and track its average. The current source 
+// drifts with temperature and supply, which moves every channel the same way;
+// if the drift grows past ~6% the current is retrimmed through ITRIM so the
+// pads stay inside the ADC range. Returns the averaged reference (x16).
+static uint16_t TrackReference() {
+    uint16_t ref = CTMUSample(REFERENCE_ADC_CHANNEL);
+    if (refReseed || first > 0) {  // warm-up or fresh trim: take as is
+        refAvg = ref * 16;
+        refReseed = 0;
+        if (first > 0) refTarget = refAvg;
+        return refAvg;
+    }
+    refAvg = refAvg + (ref - refAvg/16);  // same filter as the pad averages
+
+    if (refHoldoff > 0) {
+        refHoldoff--;
+    } else {
+        uint16_t limit = refTarget >> REF_RETRIM_SHIFT;
+        int8_t step = 0;
+        if (refAvg > refTarget + limit && ctmuTrim > -ITRIM_MAX) step = -1;
+        if (refAvg < refTarget - limit && ctmuTrim < ITRIM_MAX) step = 1;
+        if (step != 0) {
+            ctmuTrim += step;
+            CTMUICONbits.ITRIM = ctmuTrim & 0x3F;  // 6 bit two's complement
+            refReseed = 1;
+            refHoldoff = REF_RETRIM_HOLDOFF;
+        }
     }
-    buttonInd = 0;
-    first = 160;  // detection starts here after averaging over enough values
+    return refAvg;
 }
 
 // Capacitive touch sensing service routine for CTMU:  Measure, determine if 
 // button under test is pressed or not, set flag accordingly, then average.
+// Readings are normalized to the reference channel so the averages don't
+// chase current source drift.
+// Faulted pads are skipped except for an occasional probe. A focus pad read
+// more than once in a scan updates its average and health only on the first
+// reading, the others only detect presses.
 // The Starter Kit's potentiometer is also read here.
 void ReadCTMU() {
-    uint16_t current_ipl;
+    PROFILE_SCOPE(PROF_READ_CTMU);
     volatile unsigned int tempADch;
+    const uint8_t allPads = (1 << NUM_TOUCHPADS) - 1;
+    uint8_t focus = focusMask & allPads;
+    uint8_t read = 0;  // pads already read in this scan
+    ClockBoost();  // the charge time is counted in instruction cycles
     tempADch            = AD1CHS;  // store the current A/D mux channel selected
     AD1CON1             = 0x0000;  // unsigned integer format
     AD1CSSL             = 0x0000;
     AD1CON3             = 0x0002;
     AD1CON2             = 0x0000;
     AD1CON1bits.ADON    = 1;            // Start A/D in continuous mode
-    for(uint8_t i=0; i<NUM_TOUCHPADS; i++) {
+    scanCount++;
+    uint16_t ref = TrackReference();
+    if (first == 0) {  // once per scan: pace the averaging
+        if (AvgIndex < AVG_DELAY) AvgIndex++; else AvgIndex = 0;
+    }
+    for(uint8_t slot=0; slot<SCAN_BUDGET; slot++) {
+        // pick the pad for this slot: with a focus set, slot 0 visits the
+        // other pads in turn and the remaining slots cycle the focus pads
+        uint8_t pad;
+        if (focus == 0 || focus == allPads) {
+            pad = NextPadIn(allPads, &buttonInd);
+        } else if (slot == 0) {
+            pad = NextPadIn(allPads & ~focus, &backgroundInd);
+        } else {
+            pad = NextPadIn(focus, &buttonInd);
+        }
+        // don't spend scan time on faulted pads, just probe them now and then
+        if (padHealth[pad] != PAD_OK && (scanCount & HEALTH_PROBE_MASK)) {
+            continue;
+        }
         // Get the raw sensor reading:
-        AD1CHS = STARTING_ADC_CHANNEL + buttonInd; //select A/D channel
-        IFS0bits.AD1IF = 0;  // ensure touch circuit is discharged
-        AD1CON1bits.DONE = 0;
-        AD1CON1bits.SAMP = 1;        // manually sample
-        // wait for ADC to begin sampling
-        Nop(); Nop(); Nop(); Nop(); Nop(); Nop(); Nop(); Nop();
-        CTMUCONbits.IDISSEN = 1;  // drain any charge on circuit
-        Nop(); Nop(); Nop(); Nop(); Nop();
-        CTMUCONbits.IDISSEN = 0;
-        Nop(); Nop(); Nop(); Nop(); Nop();
-        IFS0bits.AD1IF = 0;
-        AD1CON1bits.SAMP = 0;  // manually start conversion
-        while(!IFS0bits.AD1IF);  // ADC to drain CTMU charge
-
-        SET_AND_SAVE_CPU_IPL( current_ipl, 7 );  // turn off interrupts
-        IFS0bits.AD1IF = 0;
-        AD1CON1bits.SAMP = 1;      // manually start sampling
-        CTMUCONbits.EDG2STAT = 0;  // make sure edge2 is 0
-        CTMUCONbits.EDG1STAT = 1;   // set edge1 - start charge
-        for (uint8_t j=0; j<CHARGE_TIME_COUNT; j++); // CTMU charge time delay
-        CTMUCONbits.EDG1STAT = 0;  // Clear edge1 - Stop Charge
-        RESTORE_CPU_IPL( current_ipl );  // re-enable interrupts
-
-        IFS0bits.AD1IF = 0;
-        AD1CON1bits.SAMP = 0;
-        while(!IFS0bits.AD1IF);  // wait for ADC
-        value = ADC1BUF0;
-        
-        IFS0bits.AD1IF = 0;    // discharge touch circuit
-        AD1CON1bits.SAMP = 1;  // manually start sampling
-
-        // wait for A/D conversion to begin
-        Nop(); Nop(); Nop(); Nop(); Nop(); Nop(); Nop(); Nop();
-        CTMUCONbits.IDISSEN = 1;        // drain any charge on circuit
-        Nop(); Nop(); Nop(); Nop(); Nop(); 
-        CTMUCONbits.IDISSEN = 0;        // end charge drain
-        Nop(); Nop(); Nop(); Nop();
-        IFS0bits.AD1IF = 0;
-        AD1CON1bits.SAMP = 0;    // perform conversion
-        while(!IFS0bits.AD1IF);  // wait for ADC
-        IFS0bits.AD1IF = 0;
-        AD1CON1bits.DONE = 0;  // ADC to drain CTMU charge
+        uint16_t raw = CTMUSample(STARTING_ADC_CHANNEL + pad);
+        uint32_t sampleTime = micros();
+        value = raw;
+        if (ref > 0) {  // drift, scaled back into the 10 bit range
+            uint32_t scaled = (uint32_t)raw * refTarget / ref;
+            value = (scaled > ADC_FULL_SCALE) ? ADC_FULL_SCALE : (uint16_t)scaled;
+        }
         
         bigVal = value  * 16; // *16 for greater sensitivity
         
-        smallAvg = average[buttonInd]/16;  // smallAvg = average >> 4 bits
-        rawCTMU[buttonInd] = bigVal;       // raw array = most recent bigVal
+        smallAvg = average[pad]/16;  // smallAvg = average >> 4 bits
+        rawCTMU[pad] = bigVal;       // raw array = most recent bigVal
         if (first > 0) {  // on power-up, reach steady-state readings first
-            first--;
-            average[buttonInd] = bigVal;
-            if (++buttonInd == NUM_TOUCHPADS) buttonInd = 0;
-            break;
+            first--;          // (every slot of a scan, warm-up goes 5x faster)
+            average[pad] = bigVal;
+            continue;
         }
+        uint8_t extra = (read >> pad) & 1;  // focus pad, read again
+        read |= 1 << pad;
         // is keypad pressed or released?
-        if (bigVal > (average[buttonInd]-trip[buttonInd]+hyst[buttonInd])) {
-            buttons[buttonInd] = 0;
-        } else if (bigVal < (average[buttonInd] - trip[buttonInd])) {
-            buttons[buttonInd] = 1;
+        uint8_t wasPressed = buttons[pad];
+        if (bigVal > (average[pad]-trip[pad]+hyst[pad])) {
+            padTouched[pad] = 0;
+        } else if (bigVal < (average[pad] - trip[pad])) {
+            padTouched[pad] = 1;
         }
+        buttons[pad] = padTouched[pad];
+        if (!extra) {
+            CheckPadHealth(pad, raw);
+        } else if (padHealth[pad] != PAD_OK) {
+            buttons[pad] = 0;
+        }
+        if (buttons[pad] != wasPressed) {
+            TouchPushEvent(pad, buttons[pad], sampleTime);
+        }
+        if (extra) continue;  // health and averages count scans, not reads
         // implement quick-release for released button
-        if (bigVal > average[buttonInd]) {  // if raw above average,
-            average[buttonInd] = bigVal;    // then reset to high average
+        if (bigVal > average[pad]) {  // if raw above average,
+            average[pad] = bigVal;    // then reset to high average
         }
         // average in the new value:
-        if(buttonInd == 0) {
-            if (AvgIndex < AVG_DELAY) AvgIndex++; else AvgIndex = 0;
-        }
         if (AvgIndex == AVG_DELAY) {  // average raw value
-            average[buttonInd] = average[buttonInd] + (value - smallAvg);
+            average[pad] = average[pad] + (value - smallAvg);
         }
-        if (++buttonInd == NUM_TOUCHPADS) buttonInd = 0;  // move to next pad
     }
     ReadPotentiometer();  // read potentiometer in _potADC
     AD1CHS = tempADch;    // restore A/D channel select
-}
\ No newline at end of file
+    ClockRelease();
+}
+
+// Scan pads in mask more often than the others (see ReadCTMU). The total
+// number of measurements per scan stays SCAN_BUDGET. 0 = no preference.
+void TouchSetFocus(uint8_t mask) {
+    focusMask = mask;
+}
+
+// Touch strength of a pad: how far the latest reading fell below its average.
+// Uses the values ReadCTMU() already stored, so it costs no extra scan.
+uint16_t PadSignal(uint8_t pad) {
+    if (rawCTMU[pad] >= average[pad]) return 0;
+    return average[pad] - rawCTMU[pad];
+}
+
+// returns 1 if pad is already part of the swipe
+static uint8_t SwipeVisited(uint8_t pad) {
+    for (uint8_t i = 0; i < swipe.length; i++) {
+        if (swipe.pad[i] == pad) return 1;
+    }
+    return 0;
+}
+
+// clear the trajectory before a new swipe
+void SwipeStart() {
+    swipe.length = 0;
+    for (uint8_t i = 0; i < NUM_TOUCHPADS; i++) {
+        swipe.pad[i] = SWIPE_NO_PAD;
+        swipe.dwell[i] = 0;
+    }
+    for (uint8_t i = 0; i < NUM_TOUCHPADS - 1; i++) {
+        swipe.transition[i] = 0;
+        swipe.velocity[i] = 0;
+    }
+    crossPad = SWIPE_NO_PAD;
+}
+
+// Feed the pad the caller currently considers active (SWIPE_NO_PAD if none)
+// once per scan. Dwell and transition times come from the activePad changes;
+// velocity comes from how fast the signal ratio between the current pad and
+// the strongest unvisited pad crosses from 25% to 75%, i.e. half a pad pitch.
+void SwipeUpdate(uint8_t activePad, uint16_t timeMs) {
+    uint8_t n = swipe.length;
+    if (n == 0) {  // waiting for the first pad
+        if (activePad < NUM_TOUCHPADS) {
+            swipe.pad[0] = activePad;
+            swipe.length = 1;
+            swipeEnter = swipeLeave = timeMs;
+        }
+        return;
+    }
+    uint8_t last = swipe.pad[n - 1];
+    if (activePad == last) swipeLeave = timeMs;  // still on current pad
+    if (n == NUM_TOUCHPADS) return;
+
+    // strongest candidate for the next pad
+    uint8_t cand = SWIPE_NO_PAD;
+    uint16_t candSig = 0;
+    for (uint8_t i = 0; i < NUM_TOUCHPADS; i++) {
+        uint16_t sig = PadSignal(i);
+        if (sig > candSig && !SwipeVisited(i)) {
+            candSig = sig;
+            cand = i;
+        }
+    }
+    if (cand != SWIPE_NO_PAD) {
+        uint32_t total = (uint32_t)candSig + PadSignal(last);
+        uint16_t ratio = (uint16_t)(((uint32_t)candSig << 8) / total);
+        if (cand != crossPad) {  // new candidate, restart timing
+            crossPad = cand;
+            crossLow = timeMs;
+            crossTime = 0;
+        }
+        if (ratio < SWIPE_RATIO_LOW) {
+            crossLow = timeMs;
+            crossTime = 0;
+        } else if (ratio >= SWIPE_RATIO_HIGH && crossTime == 0) {
+            crossTime = timeMs - crossLow;
+            if (crossTime == 0) crossTime = 1;
+        }
+    }
+
+    // entered a new pad: close the segment
+    if (activePad < NUM_TOUCHPADS && activePad != last && 
+            !SwipeVisited(activePad)) {
+        swipe.dwell[n - 1] = swipeLeave - swipeEnter;
+        swipe.transition[n - 1] = timeMs - swipeLeave;
+        swipe.velocity[n - 1] = (crossPad == activePad && crossTime > 0) ?
+                                (uint16_t)(50000UL / crossTime) : 0;
+        swipe.pad[n] = activePad;
+        swipe.length++;
+        swipeEnter = swipeLeave = timeMs;
+        crossPad = SWIPE_NO_PAD;
+    }
+}
+
+// close the dwell time of the last pad once the swipe is over
+void SwipeFinish() {
+    if (swipe.length == 0) return;
+    swipe.dwell[swipe.length - 1] = swipeLeave - swipeEnter;
+}
+
+// forget any held pad and pending double tap
+void GestureReset() {
+    gesturePad = SWIPE_NO_PAD;
+    lastTapPad = SWIPE_NO_PAD;
+}
+
+// returns 1 if this press/release completes a double tap on pad
+static uint8_t GestureIsDoubleTap(uint8_t pad, uint16_t timeMs) {
+    if (lastTapPad == pad && (uint16_t)(timeMs - lastTapTime) <= GESTURE_DOUBLE_MS) {
+        lastTapPad = SWIPE_NO_PAD;  // a third tap starts over
+        return 1;
+    }
+    return 0;
+}
+
+// Feed the pad the caller currently considers active (SWIPE_NO_PAD if none)
+// once per scan. Returns 1 and fills g when a gesture completes.
+// Repeat pads report the press at once (TAP or DOUBLE_TAP), then REPEAT at
+// an interval that shrinks by a quarter each time. Other pads report TAP or
+// DOUBLE_TAP on release, or LONG_PRESS once the hold is long enough.
+uint8_t GestureUpdate(uint8_t activePad, uint16_t timeMs, Gesture* g) {
+    g->type = GESTURE_NONE;
+    g->pad = gesturePad;
+    if (activePad != gesturePad) {
+        uint8_t released = gesturePad;
+        uint8_t wasLong = gestureLongSent;
+
+        gesturePad = activePad;   // new hold (or none)
+        gesturePress = timeMs;
+        gestureLongSent = 0;
+        gestureInterval = GESTURE_REPEAT_START_MS;
+        gestureNextRepeat = timeMs + GESTURE_REPEAT_DELAY_MS;
+
+        if (released < NUM_TOUCHPADS && !wasLong &&
+                !(GESTURE_REPEAT_PADS & (1 << released))) {  // short touch
+            g->pad = released;
+            g->type = GestureIsDoubleTap(released, timeMs)? 
+                      GESTURE_DOUBLE_TAP: GESTURE_TAP;
+            if (g->type == GESTURE_TAP) {
+                lastTapPad = released; lastTapTime = timeMs;
+            }
+            gesturePad = SWIPE_NO_PAD;  // a new pad's press is seen next time
+            return 1;
+        }
+        if (activePad < NUM_TOUCHPADS && (GESTURE_REPEAT_PADS & (1 << activePad))) {
+            g->pad = activePad;
+            g->type = GestureIsDoubleTap(activePad, timeMs)? 
+                      GESTURE_DOUBLE_TAP: GESTURE_TAP;
+            if (g->type == GESTURE_TAP) {
+                lastTapPad = activePad; lastTapTime = timeMs;
+            }
+            return 1;
+        }
+        return 0;
+    }
+    if (gesturePad >= NUM_TOUCHPADS) return 0;  // nothing held
+
+    if (GESTURE_REPEAT_PADS & (1 << gesturePad)) {
+        if ((int16_t)(timeMs - gestureNextRepeat) >= 0) {
+            g->type = GESTURE_REPEAT;
+            gestureNextRepeat = timeMs + gestureInterval;
+            gestureInterval -= gestureInterval / 4;
+            if (gestureInterval < GESTURE_REPEAT_MIN_MS) {
+                gestureInterval = GESTURE_REPEAT_MIN_MS;
+            }
+            lastTapPad = SWIPE_NO_PAD;  // a hold is no tap
+            return 1;
+        }
+    } else if (!gestureLongSent && 
+               (uint16_t)(timeMs - gesturePress) >= GESTURE_LONG_MS) {
+        g->type = GESTURE_LONG_PRESS;
+        gestureLongSent = 1;
+        lastTapPad = SWIPE_NO_PAD;
+        return 1;
+    }
+    return 0;
+}
@@ -13,13 +13,87 @@
 
 #define NUM_TOUCHPADS 5
 #define STARTING_ADC_CHANNEL 8
+// Analog input with nothing attached, measured every scan as a CTMU
+// reference for temperature/supply drift (AN13 = RB13)
+#define REFERENCE_ADC_CHANNEL 13
+
+// Cycles per iteration of the CTMU charge delay loop. The charge pulse runs
+// with interrupts masked, and its static bound (IrqMask.h) assumes this
+// cost. At -O0 XC16 emits load, compare, taken branch and increment for
+// the loop; TouchChargeLoopCycles() is the value measured at CTMUInit().
+#define CHARGE_LOOP_CYCLES  6
 
 extern uint8_t buttons[NUM_TOUCHPADS];  // up, right, down, left, center
 extern uint16_t _potADC;
 extern uint16_t rawCTMU[NUM_TOUCHPADS]; // latest raw capacitance readings
 
+// Touch events are time stamped with micros() read in the scan that saw
+// the change.
+#define TOUCH_EVENT_QUEUE       16    // must be a power of 2
+
+typedef struct {
+    uint32_t time;     // micros() of the scan that saw the change
+    uint8_t  pad;      // 0-4
+    uint8_t  pressed;  // 1 = touched, 0 = released
+} TouchEvent;
+
+// Pad health, kept up to date by ReadCTMU(). A faulted pad reads as released
+// and is only probed every few scans until it recovers.
+#define PAD_OK      0
+#define PAD_STUCK   1   // reported touched for far longer than any real touch
+#define PAD_DEAD    2   // reading frozen or pinned to an ADC rail
+
+extern uint8_t padHealth[NUM_TOUCHPADS];
+
+// Per-swipe trajectory built from the scans already taken by ReadCTMU().
+// Times are in milliseconds, velocity in 1/100 pad pitch per second.
+typedef struct {
+    uint8_t  pad[NUM_TOUCHPADS];            // pads in the order entered (0-4)
+    uint16_t dwell[NUM_TOUCHPADS];          // time each pad was the active one
+    uint16_t transition[NUM_TOUCHPADS - 1]; // from leaving a pad to the next
+    uint16_t velocity[NUM_TOUCHPADS - 1];   // 0 if crossover was not seen
+    uint8_t  length;                        // number of pads entered
+} SwipeTrace;
+
+extern SwipeTrace swipe;  // trajectory of the most recent swipe
+
+// Gestures recognized from the active pad, see GestureUpdate()
+#define GESTURE_NONE        0
+#define GESTURE_TAP         1  // short touch; on release (repeat pads: press)
+#define GESTURE_DOUBLE_TAP  2  // second tap on the same pad shortly after
+#define GESTURE_LONG_PRESS  3  // held past GESTURE_LONG_MS, reported once
+#define GESTURE_REPEAT      4  // repeat pads only: held, fires faster and faster
+
+#define GESTURE_LONG_MS         700
+#define GESTURE_DOUBLE_MS       350  // max gap between the two taps
+#define GESTURE_REPEAT_DELAY_MS 450  // hold time before the first repeat
+#define GESTURE_REPEAT_START_MS 250  // first repeat interval
+#define GESTURE_REPEAT_MIN_MS   60   // fastest repeat interval
+// pads that repeat while held instead of long-pressing: UP and DOWN
+#define GESTURE_REPEAT_PADS     ((1 << 0) | (1 << 2))
+
+typedef struct {
+    uint8_t type;  // GESTURE_*
+    uint8_t pad;   // 0-4
+} Gesture;
+
 void ReadPotentiometer();
 void CTMUInit();
 void ReadCTMU();
+uint8_t TouchReady();
+uint8_t PadFaultMask();
+uint8_t TouchChargeLoopCycles(void);
+void TouchSetFocus(uint8_t mask);
+
+uint8_t TouchGetEvent(TouchEvent* e);
+void TouchFlushEvents();
+
+uint16_t PadSignal(uint8_t pad);
+void SwipeStart();
+void SwipeUpdate(uint8_t activePad, uint16_t timeMs);
+void SwipeFinish();
+
+void GestureReset();
+uint8_t GestureUpdate(uint8_t activePad, uint16_t timeMs, Gesture* g);
 
 #endif	/* TOUCHSENSE__H */
@@ -0,0 +1,544 @@
+/*
+ * User Store
+ *
+ * Record layout in flash, USER_RECORD_WORDS words, RECORDS_PER_PAGE
+ * records per page in key order:
+ *   0    key (0xFFFF erased = no user)
+ *   1    pattern, 3 bits per button (1-5), first button in bits 0-2
+ *   2    failed attempts in bits 0-7, bits 8-15 reserved (0)
+ *   3-6  inter-button timing in ms
+ * Key k is record k % RECORDS_PER_PAGE of page k / RECORDS_PER_PAGE.
+ * Each page is a page pair (Flash.h) of its copies at USER_STORE_ADDR and
+ * USER_STORE_ALT_ADDR; altPages marks the pages whose current copy is the
+ * second one, so a record is read without looking at the tags.
+ *
+ * Changes after the last compaction are in the journal (Journal.h) as
+ * REGISTER (record words 1-6), DELETE, FAILED (word 2) and UNLOCK
+ * entries. logKeys marks the keys that have any, only their records are
+ * looked up in the journal when they are read.
+ *
+ * The last page has record slots past USER_KEYS that no ID maps to. The
+ * benchmark writes its probe users there (PROBE_KEYS of them): boot
+ * neither counts them from the pages nor replays their entries, so a reset
+ * between registering and deleting a probe leaves no account behind.
+ */
+#include "UserStore.h"
+#include "Flash.h"
+#include "Journal.h"
+#include "Clock.h"
+#include "Profile.h"
+#include "Supervisor.h"
+
+#define PROBE_KEYS          8   // benchmark keys from USER_KEYS on
+#define KEY_WORDS           ((USER_KEYS + PROBE_KEYS + 15) / 16)
+FLASH_LAYOUT_ASSERT(ProbeKeysInLastPage,
+                    USER_KEYS + PROBE_KEYS <= USER_STORE_PAGES * RECORDS_PER_PAGE);
+
+// cache entry states; pending entries are not evicted before the commit
+#define CACHE_FREE      0
+#define CACHE_CLEAN     1
+#define CACHE_ATTEMPTS  2   // failed attempts changed, journaled as FAILED/UNLOCK
+#define CACHE_DIRTY     3   // new record, journaled as REGISTER
+#define CACHE_REMOVED   4   // deleted, journaled as DELETE
+#define CACHE_PENDING(state)    ((state) >= CACHE_ATTEMPTS)
+
+#define USER_ENTRY(type)    ((type) >= JOURNAL_REGISTER && (type) <= JOURNAL_UNLOCK)
+
+typedef struct {
+    UserKey key;
+    uint8_t state;
+    uint16_t lastUse;       // useClock at the last access
+    User user;
+} CacheEntry;
+
+// one bit per key, bit k & 15 of word k >> 4
+uint16_t usedKeys[KEY_WORDS];
+uint16_t lockedKeys[KEY_WORDS];
+uint16_t logKeys[KEY_WORDS];    // keys with journal entries
+uint16_t altPages[(USER_STORE_PAGES + 15) / 16];  // current copy is the second
+uint16_t userCount;
+
+CacheEntry userCache[USER_CACHE_SIZE];
+uint16_t useClock;
+UserStoreStats userStoreStats;
+
+// the records of a flash page while it is rewritten
+uint16_t pageBuffer[RECORDS_PER_PAGE * USER_RECORD_WORDS];
+
+#define KEY_WORD(k)     ((k) >> 4)
+#define KEY_BIT(k)      ((uint16_t)1 << ((k) & 15))
+
+// the current copy of a page, or with other the copy that is not
+static uint32_t PageAddress(uint16_t page, uint8_t other) {
+    uint8_t alt = ((altPages[KEY_WORD(page)] & KEY_BIT(page)) != 0) ^ other;
+    return (alt ? USER_STORE_ALT_ADDR : USER_STORE_ADDR)
+        + (uint32_t)page * FLASH_PAGE_SIZE;
+}
+
+static uint32_t RecordAddress(UserKey key) {
+    return PageAddress(key / RECORDS_PER_PAGE, 0)
+        + (key % RECORDS_PER_PAGE) * (USER_RECORD_WORDS * 2);
+}
+
+static void PackUser(UserKey key, const User* u, uint16_t* rec) {
+    uint16_t pattern = 0;
+    for (uint8_t j = PATTERN_LENGTH; j-- > 0; ) {
+        pattern = (pattern << 3) | (u->pattern[j] & 0x07);
+    }
+    rec[0] = key;
+    rec[1] = pattern;
+    rec[2] = u->failedAttempts;
+    for (uint8_t j = 0; j < PATTERN_LENGTH - 1; j++) {
+        rec[3 + j] = u->timing[j];
+    }
+}
+
+static void UnpackUser(const uint16_t* rec, User* u) {
+    for (uint8_t j = 0; j < PATTERN_LENGTH; j++) {
+        u->pattern[j] = (rec[1] >> (3 * j)) & 0x07;
+    }
+    u->failedAttempts = (uint8_t)rec[2];
+    for (uint8_t j = 0; j < PATTERN_LENGTH - 1; j++) {
+        u->timing[j] = rec[3 + j];
+    }
+}
+
+// a journal entry applied to a packed record
+static void ApplyEntry(const JournalEntry* e, uint16_t* rec) {
+    if (e->type == JOURNAL_REGISTER) {
+        rec[0] = e->arg;
+        for (uint8_t i = 0; i < USER_RECORD_WORDS - 1; i++) rec[1 + i] = e->data[i];
+    } else if (e->type == JOURNAL_DELETE) {
+        for (uint8_t i = 0; i < USER_RECORD_WORDS; i++) rec[i] = 0xFFFF;
+    } else if (e->type == JOURNAL_FAILED) {
+        rec[2] = e->data[0];
+    } else if (e->type == JOURNAL_UNLOCK) {
+        rec[2] = 0;
+    }
+}
+
+// the record in its page, then the journal entries of the key in order
+static void LoadRecord(UserKey key, User* u) {
+    uint16_t rec[USER_RECORD_WORDS];
+    uint32_t address = RecordAddress(key);
+    for (uint8_t i = 0; i < USER_RECORD_WORDS; i++) {
+        rec[i] = FlashReadWord(address);
+        address += 2;
+    }
+    if (logKeys[KEY_WORD(key)] & KEY_BIT(key)) {
+        JournalEntry e;
+        for (uint16_t pos = JournalRead(JOURNAL_FIRST, &e); pos != JOURNAL_END;
+                pos = JournalRead(pos, &e)) {
+            if (USER_ENTRY(e.type) && e.arg == key) ApplyEntry(&e, rec);
+        }
+    }
+    UnpackUser(rec, u);
+}
+
+// lowest set bit, binary search so the cost does not depend on the bit
+static uint8_t LowestBit(uint16_t bits) {
+    uint8_t n = 0;
+    if ((bits & 0xFF) == 0) { n += 8; bits >>= 8; }
+    if ((bits & 0xF) == 0)  { n += 4; bits >>= 4; }
+    if ((bits & 0x3) == 0)  { n += 2; bits >>= 2; }
+    if ((bits & 0x1) == 0)  { n += 1; }
+    return n;
+}
+
+static void SetKeyBits(UserKey key, uint8_t used, uint8_t locked) {
+    uint16_t* u = &usedKeys[KEY_WORD(key)];
+    if (used && !(*u & KEY_BIT(key))) userCount++;
+    if (!used && (*u & KEY_BIT(key))) userCount--;
+    if (used) *u |= KEY_BIT(key); else *u &= ~KEY_BIT(key);
+    if (locked) lockedKeys[KEY_WORD(key)] |= KEY_BIT(key);
+    else lockedKeys[KEY_WORD(key)] &= ~KEY_BIT(key);
+}
+
+void UserStoreInit(void) {
+    for (uint16_t w = 0; w < KEY_WORDS; w++) {
+        usedKeys[w] = lockedKeys[w] = logKeys[w] = 0;
+    }
+    userCount = 0;
+    for (uint8_t i = 0; i < USER_CACHE_SIZE; i++) {
+        userCache[i].state = CACHE_FREE;
+    }
+    for (uint16_t page = 0; page < USER_STORE_PAGES; page++) {
+        uint32_t first = USER_STORE_ADDR + (uint32_t)page * FLASH_PAGE_SIZE;
+        uint32_t second = USER_STORE_ALT_ADDR + (uint32_t)page * FLASH_PAGE_SIZE;
+        if (FlashPairCurrent(first, second) == second) {
+            altPages[KEY_WORD(page)] |= KEY_BIT(page);
+        } else {
+            altPages[KEY_WORD(page)] &= ~KEY_BIT(page);
+        }
+    }
+
+    // one read per key, two for registered users
+    for (UserKey key = 0; key < USER_KEYS; key++) {
+        uint32_t address = RecordAddress(key);
+        if (FlashReadWord(address) != key) continue;
+        uint8_t attempts = (uint8_t)FlashReadWord(address + 4);
+        SetKeyBits(key, 1, attempts >= USER_LOCK_ATTEMPTS);
+    }
+}
+
+void UserStoreReplay(const JournalEntry* e) {
+    UserKey key = e->arg;
+    if (!USER_ENTRY(e->type) || key >= USER_KEYS) return;
+
+    logKeys[KEY_WORD(key)] |= KEY_BIT(key);
+    if (e->type == JOURNAL_REGISTER) {
+        SetKeyBits(key, 1, e->data[1] >= USER_LOCK_ATTEMPTS);
+    } else if (e->type == JOURNAL_DELETE) {
+        SetKeyBits(key, 0, 0);
+    } else if (UserExists(key)) {
+        SetKeyBits(key, 1, e->type == JOURNAL_FAILED
+                           && e->data[0] >= USER_LOCK_ATTEMPTS);
+    }
+}
+
+UserKey UserKeyOf(uint16_t userId) {
+    UserKey key = 0;
+    uint16_t weight = 1;
+
+    if (userId == 0) return USER_NONE;
+    for (uint8_t i = 0; i < USER_ID_DIGITS && userId != 0; i++) {
+        uint8_t digit = userId % 10;
+        userId /= 10;
+        if (digit < 1 || digit > USER_DIGIT_MAX) return USER_NONE;
+        key += (digit - 1) * weight;
+        weight *= USER_DIGIT_MAX;
+    }
+    return (userId == 0) ? key : USER_NONE;
+}
+
+uint16_t UserIdOf(UserKey key) {
+    uint16_t userId = 0;
+    uint16_t weight = 1;
+
+    for (uint8_t i = 0; i < USER_ID_DIGITS; i++) {
+        userId += (key % USER_DIGIT_MAX + 1) * weight;
+        key /= USER_DIGIT_MAX;
+        weight *= 10;
+    }
+    return userId;
+}
+
+uint8_t UserExists(UserKey key) {
+    return key < USER_KEYS && (usedKeys[KEY_WORD(key)] & KEY_BIT(key)) != 0;
+}
+
+uint8_t UserIsLocked(UserKey key) {
+    return key < USER_KEYS && (lockedKeys[KEY_WORD(key)] & KEY_BIT(key)) != 0;
+}
+
+uint16_t UserCount(void) {
+    return userCount;
+}
+
+static UserKey NextKey(const uint16_t* map, UserKey from) {
+    if (from >= USER_KEYS) return USER_NONE;
+
+    uint16_t w = KEY_WORD(from);
+    uint16_t bits = map[w] & (0xFFFF << (from & 15));
+    while (bits == 0) {
+        if (++w >= KEY_WORDS) return USER_NONE;
+        bits = map[w];
+    }
+    return (w << 4) + LowestBit(bits);
+}
+
+UserKey UserNext(uint8_t set, UserKey from) {
+    return NextKey((set == USER_SET_LOCKED) ? lockedKeys : usedKeys, from);
+}
+
+static CacheEntry* CacheFind(UserKey key) {
+    for (uint8_t i = 0; i < USER_CACHE_SIZE; i++) {
+        if (userCache[i].state != CACHE_FREE && userCache[i].key == key) {
+            return &userCache[i];
+        }
+    }
+    return 0;
+}
+
+// a free entry, else the least recently used clean one; with every entry
+// dirty the changes are committed first
+static CacheEntry* CacheAllocate(UserKey key) {
+    CacheEntry* victim = 0;
+    for (uint8_t pass = 0; victim == 0; pass++) {
+        if (pass > 0) UserStoreCommit();
+        for (uint8_t i = 0; i < USER_CACHE_SIZE; i++) {
+            CacheEntry* c = &userCache[i];
+            if (c->state == CACHE_FREE) {
+                victim = c;
+                break;
+            }
+            if (c->state == CACHE_CLEAN
+                    && (victim == 0 || (uint16_t)(useClock - c->lastUse)
+                                       > (uint16_t)(useClock - victim->lastUse))) {
+                victim = c;
+            }
+        }
+    }
+    victim->key = key;
+    victim->state = CACHE_CLEAN;
+    return victim;
+}
+
+// cached entry of a registered user, read from flash on a miss
+static CacheEntry* CacheLoad(UserKey key) {
+    if (!UserExists(key)) return 0;
+
+    CacheEntry* c = CacheFind(key);
+    if (c != 0) {
+        userStoreStats.hits++;
+    } else {
+        c = CacheAllocate(key);
+        LoadRecord(key, &c->user);
+        userStoreStats.misses++;
+    }
+    c->lastUse = ++useClock;
+    return c;
+}
+
+const User* UserGet(UserKey key) {
+    PROFILE_SCOPE(PROF_USER_GET);
+    CacheEntry* c = CacheLoad(key);
+    return c ? &c->user : 0;
+}
+
+// UserPut and UserRemove without the range check, also for probe keys
+static void PutKey(UserKey key, const User* u) {
+    CacheEntry* c = CacheFind(key);
+    if (c == 0) c = CacheAllocate(key);
+    c->user = *u;
+    c->state = CACHE_DIRTY;
+    c->lastUse = ++useClock;
+    SetKeyBits(key, 1, u->failedAttempts >= USER_LOCK_ATTEMPTS);
+}
+
+static void RemoveKey(UserKey key) {
+    CacheEntry* c = CacheFind(key);
+    if (c == 0) c = CacheAllocate(key);
+    c->state = CACHE_REMOVED;
+    SetKeyBits(key, 0, 0);
+}
+
+uint8_t UserPut(UserKey key, const User* u) {
+    if (key >= USER_KEYS) return 0;
+    PutKey(key, u);
+    return 1;
+}
+
+uint8_t UserSetAttempts(UserKey key, uint8_t attempts) {
+    CacheEntry* c = CacheLoad(key);
+    if (c == 0) return 0;
+
+    c->user.failedAttempts = attempts;
+    if (c->state == CACHE_CLEAN) c->state = CACHE_ATTEMPTS;
+    SetKeyBits(key, 1, attempts >= USER_LOCK_ATTEMPTS);
+    return 1;
+}
+
+uint8_t UserRemove(UserKey key) {
+    if (!UserExists(key)) return 0;
+    RemoveKey(key);
+    return 1;
+}
+
+uint8_t UserStoreDirty(void) {
+    for (uint8_t i = 0; i < USER_CACHE_SIZE; i++) {
+        if (CACHE_PENDING(userCache[i].state)) return 1;
+    }
+    return 0;
+}
+
+// the records of the page's current copy
+static void ReadPage(uint16_t page) {
+    uint32_t address = PageAddress(page, 0);
+    for (uint16_t i = 0; i < RECORDS_PER_PAGE * USER_RECORD_WORDS; i++) {
+        pageBuffer[i] = FlashReadWord(address);
+        address += 2;
+    }
+}
+
+// writes the records to the other copy of the page, which then becomes
+// current; a reset before that leaves the current copy as it was
+static void WritePage(uint16_t page) {
+    FlashPairWrite(PageAddress(page, 0), PageAddress(page, 1),
+                   pageBuffer, RECORDS_PER_PAGE * USER_RECORD_WORDS);
+    altPages[KEY_WORD(page)] ^= KEY_BIT(page);
+    userStoreStats.pageWrites++;
+}
+
+// One journal entry per pending cache entry. A full journal compacts
+// instead (JournalAppend), which writes the pending entries to the pages.
+void UserStoreCommit(void) {
+    PROFILE_SCOPE(PROF_USER_COMMIT);
+    uint16_t data[JOURNAL_DATA_MAX];
+    uint8_t type;
+
+    ClockBoost();
+    for (uint8_t i = 0; i < USER_CACHE_SIZE; i++) {
+        CacheEntry* c = &userCache[i];
+        if (!CACHE_PENDING(c->state)) continue;
+
+        if (c->state == CACHE_REMOVED) {
+            type = JOURNAL_DELETE;
+        } else if (c->state == CACHE_DIRTY) {
+            uint16_t rec[USER_RECORD_WORDS];
+            PackUser(c->key, &c->user, rec);
+            for (uint8_t w = 0; w < USER_RECORD_WORDS - 1; w++) data[w] = rec[1 + w];
+            type = JOURNAL_REGISTER;
+        } else if (c->user.failedAttempts == 0) {
+            type = JOURNAL_UNLOCK;
+        } else {
+            data[0] = c->user.failedAttempts;
+            type = JOURNAL_FAILED;
+        }
+        if (JournalAppend(type, c->key, data)) {
+            logKeys[KEY_WORD(c->key)] |= KEY_BIT(c->key);
+        }
+        if (CACHE_PENDING(c->state)) {  // not written by a compaction
+            c->state = (c->state == CACHE_REMOVED) ? CACHE_FREE : CACHE_CLEAN;
+        }
+    }
+    ClockRelease();
+}
+
+// Pages with journal entries or pending changes are rewritten once each:
+// the page, its keys' journal entries in order, then the pending cache
+// entries, which are newer than the journal.
+void UserStoreCompact(void) {
+    JournalEntry e;
+
+    ClockBoost();
+    for (uint8_t i = 0; i < USER_CACHE_SIZE; i++) {
+        if (CACHE_PENDING(userCache[i].state)) {
+            logKeys[KEY_WORD(userCache[i].key)] |= KEY_BIT(userCache[i].key);
+        }
+    }
+
+    for (UserKey key = NextKey(logKeys, 0); key != USER_NONE; ) {
+        uint16_t page = key / RECORDS_PER_PAGE;
+        UserKey first = page * RECORDS_PER_PAGE;
+
+        ReadPage(page);
+        for (uint16_t pos = JournalRead(JOURNAL_FIRST, &e); pos != JOURNAL_END;
+                pos = JournalRead(pos, &e)) {
+            if (USER_ENTRY(e.type) && e.arg >= first && e.arg < first + RECORDS_PER_PAGE) {
+                ApplyEntry(&e, &pageBuffer[(e.arg - first) * USER_RECORD_WORDS]);
+            }
+        }
+        for (uint8_t i = 0; i < USER_CACHE_SIZE; i++) {
+            CacheEntry* c = &userCache[i];
+            if (!CACHE_PENDING(c->state) || c->key / RECORDS_PER_PAGE != page) continue;
+
+            uint16_t* rec = &pageBuffer[(c->key - first) * USER_RECORD_WORDS];
+            if (c->state == CACHE_REMOVED) {
+                for (uint8_t w = 0; w < USER_RECORD_WORDS; w++) rec[w] = 0xFFFF;
+                c->state = CACHE_FREE;
+            } else {
+                PackUser(c->key, &c->user, rec);
+                c->state = CACHE_CLEAN;
+            }
+        }
+        WritePage(page);
+        SupervisorKick();  // every page may be touched, longer than the watchdog
+
+        key = NextKey(logKeys, first + RECORDS_PER_PAGE);
+    }
+
+    for (uint16_t w = 0; w < KEY_WORDS; w++) {
+        logKeys[w] = 0;
+    }
+    ClockRelease();
+}
+
+const UserStoreStats* UserStoreGetStats(void) {
+    return &userStoreStats;
+}
+
+// Cycle counts include the two ProfileCycles() reads around each sample.
+// A register and delete pair journals 8 words; when it fills the journal,
+// the compaction is part of that sample, as it is for a real user. The
+// pairs use the probe keys, the same code path as a user's key.
+#define BENCH_LOADS  64
+
+void UserStoreBenchmark(UserStoreBench* b) {
+    uint32_t total = 0;
+    b->findMax = 0;
+    for (UserKey key = 0; key < USER_KEYS; key++) {
+        uint16_t userId = UserIdOf(key);
+        uint32_t start = ProfileCycles();
+        volatile uint8_t found = UserExists(UserKeyOf(userId));
+        uint32_t cycles = ProfileCycles() - start;
+        (void)found;
+        total += cycles;
+        if (cycles > b->findMax) b->findMax = cycles;
+    }
+    b->findMean = total / USER_KEYS;
+
+    User u;
+    total = 0;
+    b->loadMax = 0;
+    b->loads = 0;
+    for (UserKey key = UserNext(USER_SET_USED, 0);
+            key != USER_NONE && b->loads < BENCH_LOADS;
+            key = UserNext(USER_SET_USED, key + 1)) {
+        uint32_t start = ProfileCycles();
+        LoadRecord(key, &u);
+        uint32_t cycles = ProfileCycles() - start;
+        total += cycles;
+        if (cycles > b->loadMax) b->loadMax = cycles;
+        b->loads++;
+    }
+    b->loadMean = b->loads ? total / b->loads : 0;
+
+    static const User probe = {{1, 2, 3, 4, 5}, 0, {300, 300, 300, 300}};
+    uint32_t removeTotal = 0;
+    total = 0;
+    b->putMax = 0;
+    b->removeMax = 0;
+    b->writes = 0;
+    UserStoreCommit();  // the samples commit only their own change
+    for (UserKey key = USER_KEYS; key < USER_KEYS + PROBE_KEYS; key++) {
+        uint32_t start = ProfileCycles();
+        PutKey(key, &probe);
+        UserStoreCommit();
+        uint32_t cycles = ProfileCycles() - start;
+        total += cycles;
+        if (cycles > b->putMax) b->putMax = cycles;
+
+        start = ProfileCycles();
+        RemoveKey(key);
+        UserStoreCommit();
+        cycles = ProfileCycles() - start;
+        removeTotal += cycles;
+        if (cycles > b->removeMax) b->removeMax = cycles;
+        b->writes++;
+    }
+    b->putMean = b->writes ? total / b->writes : 0;
+    b->removeMean = b->writes ? removeTotal / b->writes : 0;
+}
+
+#if USER_STORE_SEED
+void UserStoreSeed(uint16_t count) {
+    static const User seed = {{1, 2, 3, 4, 5}, 0, {300, 300, 300, 300}};
+
+    UserStoreCommit();  // no pending change in a page rewritten here
+    ClockBoost();
+    for (uint16_t page = 0; page < USER_STORE_PAGES && userCount < count; page++) {
+        ReadPage(page);
+        for (uint8_t r = 0; r < RECORDS_PER_PAGE && userCount < count; r++) {
+            UserKey key = page * RECORDS_PER_PAGE + r;
+            if (key >= USER_KEYS || UserExists(key)
+                    || (logKeys[KEY_WORD(key)] & KEY_BIT(key))) continue;
+            PackUser(key, &seed, &pageBuffer[r * USER_RECORD_WORDS]);
+            SetKeyBits(key, 1, 0);
+        }
+        WritePage(page);
+        SupervisorKick();  // a full seed takes longer than the watchdog
+    }
+    ClockRelease();
+}
+#endif
@@ -0,0 +1,138 @@
+/*
+ * User Store - Header
+ *
+ * Users live in program flash, one fixed-size record per possible ID.
+ * IDs are USER_ID_DIGITS digits of 1-5 (entered with CollectDigits), so
+ * an ID read as a base-5 number is a dense key 0..USER_KEYS-1 and the
+ * key is also the record's place in flash: finding a user is a
+ * computation, not a search, and costs the same with 10 or 3000 users.
+ *
+ * RAM holds one bit per key for "registered" and "locked" and a small
+ * LRU cache of records. Changes stay in the cache (pending) until
+ * UserStoreCommit(), which appends them to the flash journal
+ * (Journal.h); the pages are only rewritten by UserStoreCompact().
+ *
+ *   UserKey key = UserKeyOf(userId);
+ *   const User* u = UserGet(key);     // NULL if not registered
+ *   if (u && u->failedAttempts < USER_LOCK_ATTEMPTS) ...
+ *
+ * A pointer from UserGet() is valid until the next call that may load a
+ * record (UserGet, UserPut, UserSetAttempts, UserRemove).
+ */
+#ifndef USERSTORE__H
+#define	USERSTORE__H
+
+#include <xc.h>
+#include "Journal.h"
+
+#define PATTERN_LENGTH      5       // fixed 5-button pattern
+#define USER_ID_DIGITS      5       // digits per user ID
+#define USER_DIGIT_MAX      5       // digits are 1-5, one per pad
+#define USER_KEYS           3125    // USER_DIGIT_MAX ^ USER_ID_DIGITS
+#define USER_LOCK_ATTEMPTS  3       // failed attempts that lock a user
+
+#define USER_STORE_ADDR     0x10400UL   // first page, after the settings page
+#define USER_STORE_ALT_ADDR 0x1BC00UL   // second copies (Flash.h page pairs)
+#define USER_RECORD_WORDS   (3 + PATTERN_LENGTH - 1)
+#define RECORDS_PER_PAGE    (FLASH_PAGE_WORDS / USER_RECORD_WORDS)
+#define USER_STORE_PAGES    ((USER_KEYS + RECORDS_PER_PAGE - 1) / RECORDS_PER_PAGE)
+#define USER_STORE_END      (USER_STORE_ADDR + USER_STORE_PAGES * FLASH_PAGE_SIZE)
+FLASH_LAYOUT_ASSERT(UserStoreBeforeJournal, USER_STORE_END <= JOURNAL_ADDR);
+FLASH_LAYOUT_ASSERT(UserStoreAltInData, USER_STORE_ALT_ADDR >= USER_STORE_END
+    && USER_STORE_ALT_ADDR + USER_STORE_PAGES * FLASH_PAGE_SIZE <= FLASH_DATA_END);
+FLASH_LAYOUT_ASSERT(UserPageFitsPair,
+                    RECORDS_PER_PAGE * USER_RECORD_WORDS <= FLASH_PAIR_WORDS);
+#define USER_CACHE_SIZE     8           // records held in RAM
+
+typedef uint16_t UserKey;
+#define USER_NONE   0xFFFF          // no key / invalid ID
+
+// user sets for UserNext()
+#define USER_SET_USED       0
+#define USER_SET_LOCKED     1
+
+// RAM copy of a user record
+typedef struct {
+    uint8_t pattern[PATTERN_LENGTH];  // 5-button pattern (1-5)
+    uint8_t failedAttempts;
+    uint16_t timing[PATTERN_LENGTH - 1];  // inter-button timing in ms
+} User;
+
+typedef struct {
+    uint32_t hits;          // UserGet served from the cache
+    uint32_t misses;        // UserGet that read the record from flash
+    uint16_t pageWrites;    // flash pages rewritten by UserStoreCompact
+} UserStoreStats;
+
+// builds the bitmaps from the pages and empties the cache
+void UserStoreInit(void);
+
+// applies a journal entry read at boot, after UserStoreInit(); entries
+// that are not about users are ignored
+void UserStoreReplay(const JournalEntry* e);
+
+// key of a decimal ID, USER_NONE if it has a digit outside 1-5 or more
+// than USER_ID_DIGITS digits; IDs with fewer digits read as if padded
+// with leading 1s (23 and 11123 are the same user)
+UserKey UserKeyOf(uint16_t userId);
+
+// decimal ID of a key, USER_ID_DIGITS digits
+uint16_t UserIdOf(UserKey key);
+
+uint8_t UserExists(UserKey key);
+uint8_t UserIsLocked(UserKey key);
+uint16_t UserCount(void);
+
+// first key >= from in the set, USER_NONE if there is none
+UserKey UserNext(uint8_t set, UserKey from);
+
+// the record, NULL if the key is not registered
+const User* UserGet(UserKey key);
+
+// creates or replaces a record, returns 0 for an invalid key
+uint8_t UserPut(UserKey key, const User* u);
+
+// changes the failed attempts of a registered user, returns 0 if absent
+uint8_t UserSetAttempts(UserKey key, uint8_t attempts);
+
+// removes a registered user, returns 0 if absent
+uint8_t UserRemove(UserKey key);
+
+// 1 while changes are waiting for UserStoreCommit()
+uint8_t UserStoreDirty(void);
+
+// appends the pending changes to the journal, a few words each
+void UserStoreCommit(void);
+
+// writes the journal's and the pending changes to the pages, one erase
+// per touched page; the journal can be reset afterwards
+void UserStoreCompact(void);
+
+const UserStoreStats* UserStoreGetStats(void);
+
+// lookup cost over every key (cycles, mean and max), the cost of reading
+// records from flash, sampled over the registered users, and the latency
+// of registering and deleting a user (UserPut or UserRemove, then
+// UserStoreCommit), sampled on probe keys no ID maps to
+typedef struct {
+    uint32_t findMean, findMax;
+    uint32_t loadMean, loadMax;
+    uint32_t putMean, putMax;
+    uint32_t removeMean, removeMax;
+    uint16_t loads;
+    uint16_t writes;
+} UserStoreBench;
+
+void UserStoreBenchmark(UserStoreBench* b);
+
+#ifndef USER_STORE_SEED
+#define USER_STORE_SEED 0
+#endif
+
+#if USER_STORE_SEED
+// registers synthetic users (pattern 1-2-3-4-5) in free keys until count
+// users exist, for benchmarks on a full store
+void UserStoreSeed(uint16_t count);
+#endif
+
+#endif	/* USERSTORE__H */
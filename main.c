@@ -5,10 +5,10 @@
  * and OLED display for the PIC24F Starter Kit.
  * 
  * Features:
- *   - 2-digit user ID
+ *   - 5-digit user ID
  *   - 5-button swipe pattern password (Android-style)
  *   - Real-time pattern visualization
- *   - Multi-user support (up to 25 users)
+ *   - Multi-user support (up to 3125 users, records in flash)
  *   - Flash-based persistent storage (survives power cycle)
  * 
  * Hardware: PIC24F Starter Kit 1
@@ -23,35 +23,77 @@
 
 // ==================== FUNCTION PROTOTYPES ====================
 
+// Functions taking a Coroutine* are coroutines (see Coroutine.h): they
+// return CO_WAITING until they are done and hand results back by pointer.
+
 // UI Functions
 void DisplayCentered(const char* text);
-void ShowMessage(const char* text, uint8_t seconds);
 void DisplayTwoLines(const char* line1, const char* line2);
 void DrawMainMenu(uint8_t screenIndex, uint8_t selectedIndex);
-void DrawListSubMenu(uint8_t screenIndex, uint8_t selectedIndex);
-void DisplayUserList(uint8_t filterType);
-void DisplayLockedUsersWithNavigation(void);
+void DrawListSubMenu(uint8_t selectedIndex);
+void DrawTimingProfiles(uint8_t selectedIndex);
+void DrawProfilePage(uint8_t page);
+uint8_t DisplayUserList(Coroutine* co, uint8_t filterType);
+uint8_t DisplayLockedUsersWithNavigation(Coroutine* co);
+void DrawPadFaults(void);
+uint8_t ShowTaskStats(Coroutine* co);
 
 // Input Functions
-uint8_t WaitForButton(void);
-int16_t CollectDigits(uint8_t numDigits, const char* prompt);
-void CollectPattern(uint8_t* pattern, uint16_t* timing);
+uint8_t WaitForButton(Coroutine* co, uint8_t* button);
+uint8_t GetGesture(Gesture* g);
+void FlushGestures(void);
+uint8_t CollectDigits(Coroutine* co, uint8_t numDigits, const char* prompt, uint16_t* result);
+uint8_t CollectPattern(Coroutine* co, uint8_t* pattern, uint16_t* timing);
+void PauseStart(uint16_t ms);
+uint8_t PauseDone(void);
+
+// Informational pause in a coroutine: over after ms, or earlier when a pad
+// is touched and released (see PauseDone)
+#define CO_PAUSE(co, ms) \
+    do { PauseStart(ms); CO_YIELD_UNTIL(co, PauseDone()); } while (0)
 
 // Database Functions
 void InitDatabase(void);
-int8_t FindUser(int16_t userId);
-uint8_t RegisterUser(int16_t userId, uint8_t* pattern, uint16_t* timing);
-uint8_t ValidateLogin(int16_t userId, uint8_t* pattern, uint16_t* timing, uint8_t* timingWarningOut, uint8_t* segmentMatches);
-uint8_t DeleteUser(int16_t userId);
-uint8_t UnlockUser(int16_t userId);
+UserKey FindUser(uint16_t userId);
+uint8_t RegisterUser(uint16_t userId, uint8_t* pattern, uint16_t* timing);
+uint8_t ValidateLogin(uint16_t userId, uint8_t* pattern, uint16_t* timing, uint8_t* timingWarningOut, uint8_t* segmentMatches);
+uint8_t DeleteUser(uint16_t userId);
+uint8_t UnlockUser(uint16_t userId);
+uint8_t RecordFailedLogin(UserKey key);
+void StartSession(UserKey key);
+void ApplyTimePolicies(void);
 
 // Flash Persistence Functions
 void FlashReadDatabase(void);
 void FlashWriteDatabase(void);
+void SaveDatabase(void);
+
+// Timing Profile Functions
+void SetTimingProfile(uint8_t index);
+void RecordTransaction(uint32_t ms);
+uint32_t AverageTransactionMs(uint8_t index);
+
+// Boot Timing Functions
+void BootBegin(uint8_t phase);
+void BootEnd(uint8_t phase);
+
+// Event Functions
+void EventSetup(void);
+Event* AuditGet(uint8_t n);
+
+// Timer-driven Functions
+void UserActivity(void);
 
 // Admin Functions
-uint8_t VerifyAdminPassword(void);
-void AdminDeleteById(void);
+uint8_t VerifyAdminPassword(Coroutine* co, uint8_t* ok);
+uint8_t AdminDeleteById(Coroutine* co);
+uint8_t SelectTimingProfile(Coroutine* co);
+uint8_t ShowProfiler(Coroutine* co);
+uint8_t ShowAuditLog(Coroutine* co);
+uint8_t SetWallClock(Coroutine* co);
+void DrawClockEditor(const uint8_t* field, uint8_t selected);
+uint8_t ShowUserStore(Coroutine* co);
+void FormatWallTime(RtccTime t, char* date, char* time);
 
 // Pattern Display Functions
 void DrawPatternGrid(void);
@@ -61,38 +103,70 @@ void UpdatePatternDisplay(uint8_t* pattern, uint8_t length);
 // Visual Feedback Functions
 void DrawCheckmark(int16_t x, int16_t y);
 void DrawX(int16_t x, int16_t y);
-void ShowLoadingAnimation(const char* baseText, uint16_t durationMs);
+uint8_t ShowLoadingAnimation(Coroutine* co, const char* baseText, uint16_t durationMs);
 void ShowSuccess(const char* message);
 void ShowError(const char* message);
 void ShowTimingAnalysis(uint8_t* segmentMatches, uint8_t totalSegments);
 
-// Utility Functions
-void delay(unsigned int milliseconds);
-void BlinkRGB(uint8_t r, uint8_t g, uint8_t b, uint8_t times, uint16_t onMs, uint16_t offMs);
+// Menu Flows (run from the UI task)
+uint8_t MainMenu(Coroutine* co);
+uint8_t RegisterFlow(Coroutine* co, uint8_t express);
+uint8_t LoginFlow(Coroutine* co, uint8_t express);
+uint8_t DeleteFlow(Coroutine* co, uint8_t express);
+uint8_t ListFlow(Coroutine* co, uint8_t express);
+
+// Tasks
+void TouchTask(void);
+void UiTask(void);
+void DisplayTask(void);
 
 // ==================== USER DATABASE ====================
 
-#define PATTERN_LENGTH 5  // Fixed 5-button pattern
+// Users are kept by UserStore (UserStore.h): records in program flash,
+// found by ID without a search, with a few hot records cached in RAM. The
+// code here adds the policies: sessions, lockouts, the deleted history.
 #define ADMIN_PASSWORD 1111  // Admin password for LIST menu access
-#define MAX_USERS 25
-#define FLASH_PAGE_ADDR  0x10000UL
-#define FLASH_VALID_FLAG 0xA5A5
-
-// User structure to hold credentials
+#define FLASH_PAGE_ADDR  FLASH_DATA_ADDR  // settings page, UserStore follows
+#define SETTINGS_ALT_ADDR 0x1B800UL       // its second copy, after the journal
+FLASH_LAYOUT_ASSERT(SettingsBeforeUserStore,
+                    FLASH_PAGE_ADDR + FLASH_PAGE_SIZE <= USER_STORE_ADDR);
+FLASH_LAYOUT_ASSERT(SettingsAltAfterJournal,
+                    SETTINGS_ALT_ADDR >= JOURNAL_ADDR + JOURNAL_PAGES * FLASH_PAGE_SIZE
+                    && SETTINGS_ALT_ADDR + FLASH_PAGE_SIZE <= USER_STORE_ALT_ADDR);
+#define FLASH_FORMAT_RAW      0xA5A5  // raw User array, only read (migration)
+#define FLASH_FORMAT_PACKED   0xA5A6  // packed records in this page (migration)
+#define FLASH_FORMAT_SETTINGS 0xA5A7  // settings only, users in UserStore
+#define LEGACY_MAX_USERS 25           // users in a RAW or PACKED page
+
+// A user with the uptime it ends at, for the session and lockout tables
 typedef struct {
-    int16_t userId;              // 2-digit ID
-    uint8_t pattern[PATTERN_LENGTH];  // 5-button pattern (1-5)
-    uint8_t isActive;            // 1 = slot used, 0 = empty
-    uint8_t failedAttempts;      // Failed login attempts counter
-    uint8_t isLoggedIn;         // 1 = currently logged in, 0 = not logged in
-    uint16_t timing[PATTERN_LENGTH - 1]; // Inter-button timing in milliseconds (4 values for 5-button pattern)
-} User;
-
-User userDatabase[MAX_USERS];
-uint8_t userCount = 0;
+    UserKey key;                 // USER_NONE = slot free
+    RtccTime end;
+} UserDeadline;
+
+// Login state, RAM only: a restart logs everybody out. A table of the
+// sessions that are open; when it is full, the session that ends first
+// is closed for the new one.
+#define SESSION_SLOTS 8
+UserDeadline sessions[SESSION_SLOTS];
+
+// Timed policies on RtccUptime(), so setting the clock does not move them:
+// a session ends SESSION_TIMEOUT_S after the login, a lockout LOCKOUT_S
+// after the failed attempt that locked the user. Both are checked when
+// the state is looked at (ApplyTimePolicies), so nothing has to run while
+// the kiosk is idle.
+#define SESSION_TIMEOUT_S 300
+#define LOCKOUT_S         900
+
+// Lockout ends of recently locked users. Locked users without an entry
+// (locked before the boot, or pushed out of the full table) end at
+// lockoutDefaultEnd, which is never earlier than their own end.
+#define LOCKOUT_SLOTS 8
+UserDeadline lockouts[LOCKOUT_SLOTS];
+RtccTime lockoutDefaultEnd;
 
 #define DELETED_HISTORY_MAX 10
-int16_t deletedHistory[DELETED_HISTORY_MAX];
+uint16_t deletedHistory[DELETED_HISTORY_MAX];
 uint8_t deletedCount = 0;
 
 // Button positions on screen (for pattern display)
@@ -100,39 +174,30 @@ uint8_t deletedCount = 0;
 const uint8_t buttonX[5] = {64, 100, 64, 28, 64};   // X coordinates
 const uint8_t buttonY[5] = {12, 32, 52, 32, 32};    // Y coordinates
 
-// Initialize database (mark all slots as empty)
+// Initialize the RAM state kept next to the store: no sessions, no
+// lockout times, empty deleted history
 void InitDatabase() {
-    for (uint8_t i = 0; i < MAX_USERS; i++) {
-        userDatabase[i].userId = 0;
-        userDatabase[i].isActive = 0;
-        userDatabase[i].failedAttempts = 0;
-        userDatabase[i].isLoggedIn = 0;
-        for (uint8_t j = 0; j < PATTERN_LENGTH; j++) {
-            userDatabase[i].pattern[j] = 0;
-        }
-        for (uint8_t j = 0; j < PATTERN_LENGTH - 1; j++) {
-            userDatabase[i].timing[j] = 0;
-        }
+    for (uint8_t i = 0; i < SESSION_SLOTS; i++) {
+        sessions[i].key = USER_NONE;
     }
-    userCount = 0;
+    for (uint8_t i = 0; i < LOCKOUT_SLOTS; i++) {
+        lockouts[i].key = USER_NONE;
+    }
+    lockoutDefaultEnd = RtccUptime() + LOCKOUT_S;
     for (uint8_t i = 0; i < DELETED_HISTORY_MAX; i++) {
         deletedHistory[i] = 0;
     }
     deletedCount = 0;
 }
 
-// Find user by ID, returns index (0-9) or -1 if not found
-int8_t FindUser(int16_t userId) {
-    for (uint8_t i = 0; i < MAX_USERS; i++) {
-        if (userDatabase[i].isActive && userDatabase[i].userId == userId) {
-            return i;  // Found at index i
-        }
-    }
-    return -1;  // Not found
+// Find user by ID, returns the store key or USER_NONE if not registered
+UserKey FindUser(uint16_t userId) {
+    UserKey key = UserKeyOf(userId);
+    return UserExists(key) ? key : USER_NONE;
 }
 
 // Compare two patterns, returns 1 if match, 0 if different
-uint8_t ComparePatterns(uint8_t* pattern1, uint8_t* pattern2) {
+uint8_t ComparePatterns(const uint8_t* pattern1, const uint8_t* pattern2) {
     for (uint8_t i = 0; i < PATTERN_LENGTH; i++) {
         if (pattern1[i] != pattern2[i]) {
             return 0;  // Mismatch
@@ -142,43 +207,32 @@ uint8_t ComparePatterns(uint8_t* pattern1, uint8_t* pattern2) {
 }
 
 // Register new user, returns 1 on success, 0 on failure
-uint8_t RegisterUser(int16_t userId, uint8_t* pattern, uint16_t* timing) {
-    // Check if database is full
-    if (userCount >= MAX_USERS) {
-        return 0;  // Database full
-    }
-    
-    // Check if user ID already exists
-    if (FindUser(userId) != -1) {
+uint8_t RegisterUser(uint16_t userId, uint8_t* pattern, uint16_t* timing) {
+    // Check if user ID already exists or cannot be stored
+    UserKey key = UserKeyOf(userId);
+    if (key == USER_NONE || UserExists(key)) {
         return 0;  // ID already exists
     }
-    
-    // Find first empty slot and add user
-    for (uint8_t i = 0; i < MAX_USERS; i++) {
-        if (!userDatabase[i].isActive) {
-            userDatabase[i].userId = userId;
-            for (uint8_t j = 0; j < PATTERN_LENGTH; j++) {
-                userDatabase[i].pattern[j] = pattern[j];
-            }
-            for (uint8_t j = 0; j < PATTERN_LENGTH - 1; j++) {
-                userDatabase[i].timing[j] = timing[j];
-            }
-            userDatabase[i].isActive = 1;
-            userDatabase[i].failedAttempts = 0;
-            userDatabase[i].isLoggedIn = 0;
-            userCount++;
-            return 1;  // Success
-        }
+
+    User u;
+    for (uint8_t j = 0; j < PATTERN_LENGTH; j++) {
+        u.pattern[j] = pattern[j];
     }
-    
-    return 0;  // Should never reach here
+    for (uint8_t j = 0; j < PATTERN_LENGTH - 1; j++) {
+        u.timing[j] = timing[j];
+    }
+    u.failedAttempts = 0;
+    UserPut(key, &u);
+    EventPublish(EVENT_USER_REGISTERED, userId);
+    return 1;  // Success
 }
 
 // Validate login using pattern and timing with per-segment analysis.
 // Returns 1 on success, 0 on failure.
 // timingWarningOut: set to 1 if pattern matches but timing doesn't (warning case)
 // segmentMatches: array of 4 values (1=match, 0=mismatch) for each timing segment
-uint8_t ValidateLogin(int16_t userId, uint8_t* pattern, uint16_t* timing, uint8_t* timingWarningOut, uint8_t* segmentMatches) {
+uint8_t ValidateLogin(uint16_t userId, uint8_t* pattern, uint16_t* timing, uint8_t* timingWarningOut, uint8_t* segmentMatches) {
+    PROFILE_SCOPE(PROF_VALIDATE_LOGIN);
     const uint8_t TIMING_TOLERANCE_PERCENT = 40; // 40% tolerance for timing match
     const uint8_t MIN_SEGMENTS_REQUIRED = 2;     // At least 2/4 segments must match
     
@@ -189,13 +243,13 @@ uint8_t ValidateLogin(int16_t userId, uint8_t* pattern, uint16_t* timing, uint8_
         segmentMatches[i] = 0;
     }
     
-    int8_t index = FindUser(userId);
-    if (index == -1) {
+    const User* u = UserGet(UserKeyOf(userId));
+    if (u == 0) {
         return 0;  // User not found
     }
     
     // Check pattern
-    if (!ComparePatterns(userDatabase[index].pattern, pattern)) {
+    if (!ComparePatterns(u->pattern, pattern)) {
         return 0;  // Wrong pattern
     }
     
@@ -203,7 +257,7 @@ uint8_t ValidateLogin(int16_t userId, uint8_t* pattern, uint16_t* timing, uint8_
     uint8_t segmentsMatched = 0;
     
     for (uint8_t i = 0; i < PATTERN_LENGTH - 1; i++) {
-        uint16_t stored = userDatabase[index].timing[i];
+        uint16_t stored = u->timing[i];
         uint16_t input = timing[i];
         
         if (stored == 0 || input == 0) {
@@ -236,14 +290,8 @@ uint8_t ValidateLogin(int16_t userId, uint8_t* pattern, uint16_t* timing, uint8_
     return 1;  // Pattern matches and enough timing segments match
 }
 
-// Delete user from database, returns 1 on success, 0 on failure
-uint8_t DeleteUser(int16_t userId) {
-    int8_t index = FindUser(userId);
-    if (index == -1) {
-        return 0;  // User not found
-    }
-    
-    // Record in deleted history (shift oldest out if full)
+// Record in deleted history (shift oldest out if full)
+static void AddDeletedHistory(uint16_t userId) {
     if (deletedCount < DELETED_HISTORY_MAX) {
         deletedHistory[deletedCount] = userId;
         deletedCount++;
@@ -253,220 +301,841 @@ uint8_t DeleteUser(int16_t userId) {
         }
         deletedHistory[DELETED_HISTORY_MAX - 1] = userId;
     }
+}
+
+// Delete user from database, returns 1 on success, 0 on failure
+uint8_t DeleteUser(uint16_t userId) {
+    UserKey key = FindUser(userId);
+    if (key == USER_NONE) {
+        return 0;  // User not found
+    }
     
-    userDatabase[index].isActive = 0;
-    userDatabase[index].userId = 0;
-    userDatabase[index].failedAttempts = 0;
-    userDatabase[index].isLoggedIn = 0;
-    for (uint8_t j = 0; j < PATTERN_LENGTH; j++) {
-        userDatabase[index].pattern[j] = 0;
+    AddDeletedHistory(userId);
+    UserRemove(key);
+    for (uint8_t i = 0; i < SESSION_SLOTS; i++) {
+        if (sessions[i].key == key) sessions[i].key = USER_NONE;
     }
-    for (uint8_t j = 0; j < PATTERN_LENGTH - 1; j++) {
-        userDatabase[index].timing[j] = 0;
+    for (uint8_t i = 0; i < LOCKOUT_SLOTS; i++) {
+        if (lockouts[i].key == key) lockouts[i].key = USER_NONE;
     }
-    
-    userCount--;  // Decrement user count
+    EventPublish(EVENT_USER_DELETED, userId);
     return 1;  // Success
 }
 
+// Entry of key in the table, else a free entry, else the one that ends
+// first; the caller overwrites it
+static UserDeadline* DeadlineSlot(UserDeadline* table, uint8_t count, UserKey key) {
+    UserDeadline* slot = &table[0];
+    for (uint8_t i = 0; i < count; i++) {
+        if (table[i].key == key) return &table[i];
+        if (slot->key != USER_NONE && (table[i].key == USER_NONE
+                || RTCC_AFTER(slot->end, table[i].end))) {
+            slot = &table[i];
+        }
+    }
+    return slot;
+}
+
+// Mark user as logged in and (re)start the session timeout
+void StartSession(UserKey key) {
+    UserDeadline* s = DeadlineSlot(sessions, SESSION_SLOTS, key);
+    s->key = key;
+    s->end = RtccUptime() + SESSION_TIMEOUT_S;
+}
+
+// When the lockout of a locked user ends
+static RtccTime LockoutEnd(UserKey key) {
+    for (uint8_t i = 0; i < LOCKOUT_SLOTS; i++) {
+        if (lockouts[i].key == key) return lockouts[i].end;
+    }
+    return lockoutDefaultEnd;
+}
+
+// End the sessions and lockouts that have run out
+void ApplyTimePolicies(void) {
+    RtccTime now = RtccUptime();
+    for (uint8_t i = 0; i < SESSION_SLOTS; i++) {
+        if (sessions[i].key != USER_NONE && RTCC_AFTER(now, sessions[i].end)) {
+            sessions[i].key = USER_NONE;
+        }
+    }
+    for (UserKey key = UserNext(USER_SET_LOCKED, 0); key != USER_NONE;
+            key = UserNext(USER_SET_LOCKED, key + 1)) {
+        if (RTCC_AFTER(now, LockoutEnd(key))) {
+            UnlockUser(UserIdOf(key));
+        }
+    }
+}
+
 // Unlock user by resetting failed attempts, returns 1 on success, 0 on failure
-uint8_t UnlockUser(int16_t userId) {
-    int8_t index = FindUser(userId);
-    if (index == -1) {
+uint8_t UnlockUser(uint16_t userId) {
+    UserKey key = FindUser(userId);
+    if (key == USER_NONE) {
         return 0;  // User not found
     }
     
     // Reset failed attempts to unlock the account
-    userDatabase[index].failedAttempts = 0;
+    UserSetAttempts(key, 0);
+    for (uint8_t i = 0; i < LOCKOUT_SLOTS; i++) {
+        if (lockouts[i].key == key) lockouts[i].key = USER_NONE;
+    }
+    EventPublish(EVENT_USER_UNLOCKED, userId);
     return 1;  // Success
 }
 
+// Count a failed login, returns the failed attempts so far (3 = locked)
+uint8_t RecordFailedLogin(UserKey key) {
+    uint8_t attempts = UserGet(key)->failedAttempts + 1;
+    UserSetAttempts(key, attempts);
+    if (attempts >= USER_LOCK_ATTEMPTS) {
+        UserDeadline* l = DeadlineSlot(lockouts, LOCKOUT_SLOTS, key);
+        if (l->key != USER_NONE && l->key != key
+                && RTCC_AFTER(l->end, lockoutDefaultEnd)) {
+            lockoutDefaultEnd = l->end;  // pushed out, ends no earlier
+        }
+        l->key = key;
+        l->end = RtccUptime() + LOCKOUT_S;
+    }
+    EventPublish(attempts >= USER_LOCK_ATTEMPTS ? EVENT_USER_LOCKED : EVENT_LOGIN_FAILED,
+                 UserIdOf(key));
+    return attempts;
+}
+
+// ==================== TIMING PROFILES ====================
+
+// UI durations. The profile table lives in program flash; the selected
+// profile and the transaction times measured with each profile are saved
+// with the database.
+typedef struct {
+    const char* name;
+    uint16_t greetMs;      // "HELLO!" at power-up
+    uint16_t introMs;      // "... MENU" and "REDIRECTING...", 0 = skip intros
+    uint16_t infoMs;       // prompts and results
+    uint16_t errorMs;      // error messages
+    uint16_t analysisMs;   // timing analysis after a login
+    uint16_t checkMs;      // "CHECKING" animation
+    uint16_t verifyMs;     // animation while a pattern is verified
+    uint8_t blinks;        // LED blinks on success/failure
+    uint16_t blinkMs;      // LED on and off time
+} TimingProfile;
+
+#define TIMING_STANDARD 0
+#define TIMING_EXPRESS  1
+#define TIMING_PROFILES 3
+
+const TimingProfile timingProfiles[TIMING_PROFILES] = {
+    {"STANDARD",   3000, 1000, 2000, 3000, 5000, 1000, 2000, 3, 200},
+    {"EXPRESS",     500,    0,  800, 1500, 2000,    0,  300, 1, 100},  // trained staff
+    {"ACCESSIBLE", 4000, 2000, 4000, 5000, 8000, 1500, 3000, 3, 400},
+};
+
+// Transactions (register, login, delete) timed from the menu selection
+// back to the menu
+typedef struct {
+    uint16_t transactions;
+    uint32_t totalMs;
+} TimingStats;
+
+uint8_t timingProfile = TIMING_STANDARD;
+const TimingProfile* ux = &timingProfiles[TIMING_STANDARD];
+TimingStats timingStats[TIMING_PROFILES];
+
+void SetTimingProfile(uint8_t index) {
+    if (index >= TIMING_PROFILES) index = TIMING_STANDARD;
+    timingProfile = index;
+    ux = &timingProfiles[index];
+}
+
+// The stats only go to the journal with the next database write, a
+// transaction alone does not cost a flash write
+void RecordTransaction(uint32_t ms) {
+    TimingStats* s = &timingStats[timingProfile];
+    if (s->transactions >= 0xFFFE) {  // keep the average, make room
+        s->transactions /= 2;
+        s->totalMs /= 2;
+    }
+    s->transactions++;
+    s->totalMs += ms;
+}
+
+uint32_t AverageTransactionMs(uint8_t index) {
+    TimingStats* s = &timingStats[index];
+    return (s->transactions > 0) ? s->totalMs / s->transactions : 0;
+}
+
 // ==================== FLASH PERSISTENCE ====================
 
-// NVM unlock sequence using pure inline assembly from DS39897C Example 5-5.
-// This bypasses __builtin_write_NVM() to guarantee correct timing.
-static void NVMUnlock(void) {
-    asm volatile(
-        "disi    #5          \n\t"
-        "mov     #0x55, w0   \n\t"
-        "mov     w0, _NVMKEY \n\t"
-        "mov     #0xAA, w0   \n\t"
-        "mov     w0, _NVMKEY \n\t"
-        "bset    _NVMCON, #15\n\t"
-        "nop                 \n\t"
-        "nop"
-        : : : "w0"
-    );
-}
-
-static void FlashErasePage(uint32_t address) {
-    uint16_t offset;
-
-    TBLPAG = (uint16_t)(address >> 16);
-    offset = (uint16_t)(address & 0xFFFF);
-    __builtin_tblwtl(offset, 0x0000);
-    NVMCON = 0x4042;
-    NVMUnlock();
-    while(NVMCONbits.WR);
-    NVMCONbits.WREN = 0;
-}
-
-static void FlashWriteWord(uint32_t address, uint16_t data) {
-    uint16_t offset;
-
-    NVMCON = 0x4003;
-    TBLPAG = (uint16_t)(address >> 16);
-    offset = (uint16_t)(address & 0xFFFF);
-    __builtin_tblwtl(offset, data);
-    __builtin_tblwth(offset, 0x00);
-    NVMUnlock();
-    while(NVMCONbits.WR);
-    NVMCONbits.WREN = 0;
+// Settings page (FLASH_FORMAT_SETTINGS), a page pair (Flash.h) of
+// FLASH_PAGE_ADDR and SETTINGS_ALT_ADDR, one 16 bit word per flash address:
+//   format, timing profile, 3 words of stats per profile,
+//   deleted count, DELETED_HISTORY_MAX deleted IDs,
+//   the journal generation the page and the UserStore pages include.
+// The users are in the UserStore pages after it. Older firmware kept the
+// users in this page too (FLASH_FORMAT_PACKED, FLASH_FORMAT_RAW); they are
+// moved to the store at the first boot.
+//
+// Changes between compactions are appended to the journal (Journal.h):
+// UserStore writes the user entries, FlashWriteDatabase() the timing
+// profile and stats. A deleted user's ID goes to the history again when
+// its JOURNAL_DELETE is replayed.
+#define SETTINGS_WORDS (2 + 3 * TIMING_PROFILES + 1 + DELETED_HISTORY_MAX + 1)
+
+static void PackSettings(uint16_t* w, uint16_t generation) {
+    *w++ = FLASH_FORMAT_SETTINGS;
+    *w++ = timingProfile;
+    for (uint8_t i = 0; i < TIMING_PROFILES; i++) {
+        *w++ = timingStats[i].transactions;
+        *w++ = (uint16_t)timingStats[i].totalMs;
+        *w++ = (uint16_t)(timingStats[i].totalMs >> 16);
+    }
+    *w++ = deletedCount;
+    for (uint8_t i = 0; i < DELETED_HISTORY_MAX; i++) {
+        *w++ = deletedHistory[i];
+    }
+    *w++ = generation;
+}
+
+// what the settings page and the journal hold, to journal only changes
+uint8_t flashProfile;
+TimingStats flashStats[TIMING_PROFILES];
+
+static void FlashTimingSaved(void) {
+    flashProfile = timingProfile;
+    for (uint8_t i = 0; i < TIMING_PROFILES; i++) flashStats[i] = timingStats[i];
+}
+
+// Writes the whole state to the UserStore pages and the settings page and
+// starts the next journal. The journal calls it when it is full. A reset
+// between the steps is safe: every page is written to the other copy of
+// its pair, so a reset during a write leaves the previous copy current,
+// and until the settings page holds the journal's generation the journal
+// is replayed again, and its entries hold absolute values.
+static void CompactDatabase(void) {
+    uint16_t settings[SETTINGS_WORDS];
+    uint16_t generation = JournalGeneration();
+
+    ClockBoost();
+
+    UserStoreCompact();
+
+    PackSettings(settings, generation);
+    uint32_t current = FlashPairCurrent(FLASH_PAGE_ADDR, SETTINGS_ALT_ADDR);
+    FlashPairWrite(current,
+                   (current == FLASH_PAGE_ADDR) ? SETTINGS_ALT_ADDR : FLASH_PAGE_ADDR,
+                   settings, SETTINGS_WORDS);
+    SupervisorKick();
+
+    JournalReset(JournalNextGeneration(generation));
+    FlashTimingSaved();
+
+    ClockRelease();
 }
 
 void FlashWriteDatabase(void) {
-    uint16_t i;
-    uint16_t dbWords;
-    uint16_t *src;
-    uint32_t addr;
+    PROFILE_SCOPE(PROF_FLASH_WRITE);
+    uint16_t data[JOURNAL_DATA_MAX];
+
+    ClockBoost();
+
+    UserStoreCommit();
+
+    // A login costs one stats entry (4 words), nothing is erased until
+    // the journal is full
+    if (timingProfile != flashProfile) {
+        if (JournalAppend(JOURNAL_PROFILE, timingProfile, data)) {
+            flashProfile = timingProfile;
+        }
+    }
+    for (uint8_t i = 0; i < TIMING_PROFILES; i++) {
+        TimingStats* s = &timingStats[i];
+        if (s->transactions == flashStats[i].transactions
+                && s->totalMs == flashStats[i].totalMs) continue;
+        data[0] = s->transactions;
+        data[1] = (uint16_t)s->totalMs;
+        data[2] = (uint16_t)(s->totalMs >> 16);
+        if (JournalAppend(JOURNAL_STATS, i, data)) flashStats[i] = *s;
+    }
+
+    ClockRelease();
+}
 
-    FlashErasePage(FLASH_PAGE_ADDR);
+// Flash writes are deferred by a software timer, so changes made in quick
+// succession go to the journal in a single commit
+#define FLASH_COMMIT_MS 250
+SoftTimer flashTimer;
 
-    addr = FLASH_PAGE_ADDR;
+static void FlashCommit(SoftTimer* t) {
+    FlashWriteDatabase();
+}
 
-    FlashWriteWord(addr, FLASH_VALID_FLAG);
-    addr += 2;
+void SaveDatabase(void) {
+    TimerStart(&flashTimer, FLASH_COMMIT_MS, 0, FlashCommit);
+}
 
-    FlashWriteWord(addr, (uint16_t)userCount);
-    addr += 2;
+// Deleted-ID history at address, returns the address after it. Two-digit
+// IDs of older firmware are shown as the 5-digit IDs they became.
+static uint32_t FlashReadDeleted(uint32_t address) {
+    deletedCount = (uint8_t)FlashReadWord(address);
+    address += 2;
+    if (deletedCount > DELETED_HISTORY_MAX) deletedCount = DELETED_HISTORY_MAX;
 
-    src = (uint16_t *)userDatabase;
-    dbWords = (sizeof(userDatabase) + 1) / 2;
-    for(i = 0; i < dbWords; i++) {
-        FlashWriteWord(addr, src[i]);
-        addr += 2;
+    for(uint16_t i = 0; i < DELETED_HISTORY_MAX; i++) {
+        uint16_t userId = FlashReadWord(address);
+        UserKey key = UserKeyOf(userId);
+        deletedHistory[i] = (key != USER_NONE) ? UserIdOf(key) : userId;
+        address += 2;
     }
+    return address;
+}
 
-    FlashWriteWord(addr, (uint16_t)deletedCount);
-    addr += 2;
+// Timing profile and its stats at address, returns the address after them
+static uint32_t FlashReadTiming(uint32_t address) {
+    // Pages written before the timing profiles existed are erased (0xFFFF)
+    // here, which selects the standard profile and empty stats
+    SetTimingProfile((uint8_t)FlashReadWord(address));
+    address += 2;
 
-    src = (uint16_t *)deletedHistory;
-    for(i = 0; i < DELETED_HISTORY_MAX; i++) {
-        FlashWriteWord(addr, src[i]);
-        addr += 2;
+    for(uint16_t i = 0; i < TIMING_PROFILES; i++) {
+        uint16_t transactions = FlashReadWord(address);
+        uint16_t totalLo = FlashReadWord(address + 2);
+        uint16_t totalHi = FlashReadWord(address + 4);
+        address += 6;
+        if (transactions == 0xFFFF) continue;  // erased, stays 0
+        timingStats[i].transactions = transactions;
+        timingStats[i].totalMs = ((uint32_t)totalHi << 16) | totalLo;
     }
+    return address;
 }
 
-void FlashReadDatabase(void) {
-    uint32_t address = FLASH_PAGE_ADDR;
-    uint16_t valid_flag;
-    uint16_t storedCount;
-    uint16_t *dest;
-    uint16_t dbWords;
-    uint16_t i;
+// Layout written by older firmware: the User array as it was in RAM
+// (including the runtime login flag), then the deleted history and the
+// timing profile.
+typedef struct {
+    int16_t userId;
+    uint8_t pattern[PATTERN_LENGTH];
+    uint8_t isActive;
+    uint8_t failedAttempts;
+    uint8_t isLoggedIn;
+    uint16_t timing[PATTERN_LENGTH - 1];
+} RawUser;
+
+static void FlashReadRaw(uint32_t address) {
+    RawUser raw;
+    uint16_t* dest = (uint16_t*)&raw;
+    User u;
+
+    address += 2;  // user count, recounted from the slots
+    for (uint8_t slot = 0; slot < LEGACY_MAX_USERS; slot++) {
+        for (uint16_t i = 0; i < sizeof(RawUser) / 2; i++) {
+            dest[i] = FlashReadWord(address);
+            address += 2;
+        }
+        if (raw.isActive != 1) continue;
+        u.failedAttempts = raw.failedAttempts;
+        for (uint8_t j = 0; j < PATTERN_LENGTH; j++) u.pattern[j] = raw.pattern[j];
+        for (uint8_t j = 0; j < PATTERN_LENGTH - 1; j++) u.timing[j] = raw.timing[j];
+        UserPut(UserKeyOf(raw.userId), &u);
+    }
+    address = FlashReadDeleted(address);
+    FlashReadTiming(address);
+}
+
+// Packed page of older firmware: timing, deleted history, user count, then
+// per user its ID, the pattern (3 bits per button), failed attempts and
+// the timing, as UserStore keeps them now
+#define LEGACY_RECORD_WORDS (3 + PATTERN_LENGTH - 1)
 
-    TBLPAG = (uint16_t)(address >> 16);
+static void FlashReadPacked(uint32_t address) {
+    uint16_t rec[LEGACY_RECORD_WORDS];
+    User u;
 
-    valid_flag = __builtin_tblrdl((uint16_t)(address & 0xFFFF));
+    address = FlashReadTiming(address);
+    address = FlashReadDeleted(address);
+
+    uint16_t count = FlashReadWord(address);
     address += 2;
+    if (count > LEGACY_MAX_USERS) count = 0;  // not a page we wrote
 
-    if(valid_flag != FLASH_VALID_FLAG) {
-        InitDatabase();
-        return;
+    for (uint8_t n = 0; n < count; n++) {
+        for (uint16_t i = 0; i < LEGACY_RECORD_WORDS; i++) {
+            rec[i] = FlashReadWord(address);
+            address += 2;
+        }
+        for (uint8_t j = 0; j < PATTERN_LENGTH; j++) {
+            u.pattern[j] = (rec[1] >> (3 * j)) & 0x07;
+        }
+        u.failedAttempts = (uint8_t)rec[2];
+        for (uint8_t j = 0; j < PATTERN_LENGTH - 1; j++) {
+            u.timing[j] = rec[3 + j];
+        }
+        UserPut(UserKeyOf(rec[0]), &u);
+    }
+}
+
+// Entries of a journal the settings page does not include yet
+static void FlashReplayJournal(void) {
+    JournalEntry e;
+    uint16_t pos = JOURNAL_FIRST;
+
+    while ((pos = JournalRead(pos, &e)) != JOURNAL_END) {
+        UserStoreReplay(&e);
+        if (e.type == JOURNAL_DELETE) {
+            if (e.arg < USER_KEYS) AddDeletedHistory(UserIdOf(e.arg));  // not a probe
+        } else if (e.type == JOURNAL_PROFILE) {
+            SetTimingProfile((uint8_t)e.arg);
+        } else if (e.type == JOURNAL_STATS && e.arg < TIMING_PROFILES) {
+            timingStats[e.arg].transactions = e.data[0];
+            timingStats[e.arg].totalMs = ((uint32_t)e.data[2] << 16) | e.data[1];
+        }
     }
+}
 
-    storedCount = __builtin_tblrdl((uint16_t)(address & 0xFFFF));
+void FlashReadDatabase(void) {
+    uint32_t address = FlashPairCurrent(FLASH_PAGE_ADDR, SETTINGS_ALT_ADDR);
+    uint16_t applied = 0xFFFF;  // no settings page, every journal is new
+
+    InitDatabase();
+    UserStoreInit();
+
+    uint16_t format = FlashReadWord(address);
     address += 2;
-    userCount = (uint8_t)storedCount;
+    if (format == FLASH_FORMAT_SETTINGS) {
+        address = FlashReadTiming(address);
+        address = FlashReadDeleted(address);
+        applied = FlashReadWord(address);
+    }
 
-    dest = (uint16_t *)userDatabase;
-    dbWords = (sizeof(userDatabase) + 1) / 2;
-    for(i = 0; i < dbWords; i++) {
-        dest[i] = __builtin_tblrdl((uint16_t)(address & 0xFFFF));
-        address += 2;
+    uint16_t generation = JournalInit(CompactDatabase);
+    if (generation == JOURNAL_NO_GENERATION || generation == applied) {
+        JournalReset(JournalNextGeneration(applied));
+    } else {
+        FlashReplayJournal();
     }
+    FlashTimingSaved();
 
-    for(i = 0; i < MAX_USERS; i++) {
-        userDatabase[i].isLoggedIn = 0;
+    if (format == FLASH_FORMAT_PACKED) {
+        FlashReadPacked(address);
+    } else if (format == FLASH_FORMAT_RAW) {
+        FlashReadRaw(address);
     }
 
-    uint16_t storedDeleted = __builtin_tblrdl((uint16_t)(address & 0xFFFF));
-    address += 2;
-    deletedCount = (uint8_t)storedDeleted;
-    if (deletedCount > DELETED_HISTORY_MAX) deletedCount = DELETED_HISTORY_MAX;
+    // users of an older page go to the store, the page becomes settings;
+    // a torn journal entry is cut off before the next append
+    if (format != FLASH_FORMAT_SETTINGS || JournalDamaged()) {
+        CompactDatabase();
+    }
+}
 
-    dest = (uint16_t *)deletedHistory;
-    for(i = 0; i < DELETED_HISTORY_MAX; i++) {
-        dest[i] = __builtin_tblrdl((uint16_t)(address & 0xFFFF));
-        address += 2;
+// ==================== INACTIVITY ====================
+
+// Without touch input the display is dimmed and the clock slowed down after
+// DIM_TIMEOUT_MS, and the menus go back to the main menu after
+// MENU_TIMEOUT_MS
+#define DIM_TIMEOUT_MS  30000UL
+#define MENU_TIMEOUT_MS 60000UL
+SoftTimer dimTimer;
+SoftTimer menuTimer;
+uint8_t displayDimmed = 0;
+uint8_t uiTimedOut = 0;        // 1 = menus should close, see MenuTimeout
+
+static void DimDisplay(SoftTimer* t) {
+    DisplaySetContrast(CONTRAST_DIM);
+    displayDimmed = 1;
+    ClockSetBase(CLOCK_LOW);  // only touch scans and flushes run boosted
+}
+
+static void MenuTimeout(SoftTimer* t) {
+    uiTimedOut = 1;
+}
+
+// Restart the inactivity timers, called for every scan with a pad touched
+void UserActivity(void) {
+    TimerStart(&dimTimer, DIM_TIMEOUT_MS, 0, DimDisplay);
+    TimerStart(&menuTimer, MENU_TIMEOUT_MS, 0, MenuTimeout);
+    uiTimedOut = 0;
+    if (displayDimmed) {
+        ClockSetBase(CLOCK_HIGH);
+        DisplaySetContrast(CONTRAST_NORMAL);
+        displayDimmed = 0;
     }
 }
 
+// ==================== EVENTS ====================
+
+// Subscribers of the event bus (Event.h): LED feedback, the audit log and
+// the flash commit react to the database and login events, so the code
+// that changes the data only publishes.
+
+// Audit log of the last AUDIT_SIZE security events, RAM only
+#define AUDIT_SIZE 8
+
+const char* const eventNames[EVENT_TOPICS] = {
+    "DB", "REGIST", "DELETE", "UNLOCK", "LOGIN", "FAILED", "LOCKED", "DENIED",
+};
+
+Event auditLog[AUDIT_SIZE];
+uint8_t auditNext = 0;         // slot for the next record
+uint8_t auditCount = 0;
+
+static void AuditRecord(const Event* e) {
+    auditLog[auditNext] = *e;
+    auditNext = (auditNext + 1) % AUDIT_SIZE;
+    if (auditCount < AUDIT_SIZE) auditCount++;
+}
+
+// n = 0 is the newest record
+Event* AuditGet(uint8_t n) {
+    return &auditLog[(auditNext + AUDIT_SIZE - 1 - n) % AUDIT_SIZE];
+}
+
+static void BlinkSuccess(const Event* e) {
+    RGBBlink(0, 255, 0, ux->blinks, ux->blinkMs, ux->blinkMs);
+}
+
+static void BlinkFailure(const Event* e) {
+    RGBBlink(255, 0, 0, ux->blinks, ux->blinkMs, ux->blinkMs);
+}
+
+static void CommitDatabase(const Event* e) {
+    SaveDatabase();
+}
+
+void EventSetup(void) {
+    EventInit();
+    EventSubscribe(EVENT_DB_CHANGED, CommitDatabase);
+    EventSubscribe(EVENT_USER_REGISTERED, BlinkSuccess);
+    EventSubscribe(EVENT_USER_REGISTERED, AuditRecord);
+    EventSubscribe(EVENT_USER_REGISTERED, CommitDatabase);
+    EventSubscribe(EVENT_USER_DELETED, BlinkSuccess);
+    EventSubscribe(EVENT_USER_DELETED, AuditRecord);
+    EventSubscribe(EVENT_USER_DELETED, CommitDatabase);
+    EventSubscribe(EVENT_USER_UNLOCKED, BlinkSuccess);
+    EventSubscribe(EVENT_USER_UNLOCKED, AuditRecord);
+    EventSubscribe(EVENT_USER_UNLOCKED, CommitDatabase);
+    EventSubscribe(EVENT_LOGIN_OK, BlinkSuccess);
+    EventSubscribe(EVENT_LOGIN_OK, AuditRecord);
+    EventSubscribe(EVENT_LOGIN_FAILED, BlinkFailure);
+    EventSubscribe(EVENT_LOGIN_FAILED, AuditRecord);
+    EventSubscribe(EVENT_LOGIN_FAILED, CommitDatabase);
+    EventSubscribe(EVENT_USER_LOCKED, BlinkFailure);
+    EventSubscribe(EVENT_USER_LOCKED, AuditRecord);
+    EventSubscribe(EVENT_USER_LOCKED, CommitDatabase);
+    EventSubscribe(EVENT_ADMIN_DENIED, BlinkFailure);
+    EventSubscribe(EVENT_ADMIN_DENIED, AuditRecord);
+}
+
 // ==================== ADMIN FUNCTIONS ====================
 
-// Verify admin password, returns 1 if correct, 0 if incorrect
-uint8_t VerifyAdminPassword(void) {
+// Verify admin password, sets *ok to 1 if correct, 0 if incorrect
+uint8_t VerifyAdminPassword(Coroutine* co, uint8_t* ok) {
+    static Coroutine sub;
+    static uint16_t enteredPassword;
+
+    CO_BEGIN(co);
     DisplayTwoLines("ENTER ADMIN", "PASSWORD");
-    delay(2000);
+    CO_PAUSE(co, ux->infoMs);
     
     // Collect 4-digit password
-    int16_t enteredPassword = CollectDigits(4, "PASS");
+    CO_SPAWN(co, &sub, CollectDigits(&sub, 4, "PASS", &enteredPassword));
     
     // Verify password
     if (enteredPassword == ADMIN_PASSWORD) {
-        return 1;  // Password correct
+        *ok = 1;  // Password correct
     } else {
-        return 0;  // Password incorrect
+        *ok = 0;  // Password incorrect
     }
+    CO_END(co);
 }
 
 // Admin-only delete by user ID from LIST menu (no user pattern required)
-void AdminDeleteById(void) {
+uint8_t AdminDeleteById(Coroutine* co) {
+    static Coroutine sub;
+    static uint16_t userId;
+    static uint8_t btn;
+
+    CO_BEGIN(co);
     // Brief info screen
     DisplayTwoLines("DEL USER BY", "ID");
-    delay(2000);
+    CO_PAUSE(co, ux->infoMs);
 
     // Prompt for target user ID
     DisplayTwoLines("ENTER USER", "ID");
-    delay(2000);
+    CO_PAUSE(co, ux->infoMs);
 
-    // Collect 2-digit ID
-    int16_t userId = CollectDigits(2, "ID");
+    // Collect the ID
+    CO_SPAWN(co, &sub, CollectDigits(&sub, USER_ID_DIGITS, "ID", &userId));
 
     // Check if user exists
-    int8_t userIndex = FindUser(userId);
-    if (userIndex == -1) {
-        ShowLoadingAnimation("CHECKING", 1000);
-        BlinkRGB(255, 0, 0, 3, 200, 200);
+    if (FindUser(userId) == USER_NONE) {
+        CO_SPAWN(co, &sub, ShowLoadingAnimation(&sub, "CHECKING", ux->checkMs));
+        RGBBlink(255, 0, 0, ux->blinks, ux->blinkMs, ux->blinkMs);
         ShowError("INVALID USER ID");
-        delay(3000);
-        return;
+        CO_PAUSE(co, ux->errorMs);
+        CO_EXIT(co);
     }
 
     // Final confirmation before delete
     char confirmLine[20];
-    sprintf(confirmLine, "DEL ID %02d?", userId);
+    sprintf(confirmLine, "DEL ID %05u?", userId);
     DisplayTwoLines(confirmLine, "CENTER=YES");
-    delay(2000);
+    CO_PAUSE(co, ux->infoMs);
 
-    uint8_t btn = WaitForButton();
+    CO_SPAWN(co, &sub, WaitForButton(&sub, &btn));
     if (btn != 4) {
         DisplayTwoLines("CANCELLED", "");
-        delay(2000);
-        return;
+        CO_PAUSE(co, ux->infoMs);
+        CO_EXIT(co);
     }
 
     // Perform delete
-    if (DeleteUser(userId)) {
-        FlashWriteDatabase();
-        BlinkRGB(0, 255, 0, 3, 200, 200);
+    if (DeleteUser(userId)) {  // GREEN blink, commit on the event
         ShowSuccess("USER DELETED");
-        delay(2000);
+        CO_PAUSE(co, ux->infoMs);
     } else {
-        BlinkRGB(255, 0, 0, 3, 200, 200);
+        RGBBlink(255, 0, 0, ux->blinks, ux->blinkMs, ux->blinkMs);
         ShowError("DELETE FAILED");
-        delay(2000);
+        CO_PAUSE(co, ux->infoMs);
+    }
+    CO_END(co);
+}
+
+// Choose the timing profile: UP/DOWN move, CENTER selects and saves it,
+// LEFT goes back unchanged
+uint8_t SelectTimingProfile(Coroutine* co) {
+    static Coroutine sub;
+    static uint8_t selected;
+    static uint8_t btn;
+
+    CO_BEGIN(co);
+    selected = timingProfile;
+    while (1) {
+        DrawTimingProfiles(selected);
+        CO_SPAWN(co, &sub, WaitForButton(&sub, &btn));
+        if (btn == 0xFF || btn == 3) CO_EXIT(co);  // timeout or LEFT
+
+        if (btn == 0) {
+            selected = (selected > 0) ? selected - 1 : TIMING_PROFILES - 1;
+        } else if (btn == 2) {
+            selected = (selected < TIMING_PROFILES - 1) ? selected + 1 : 0;
+        } else if (btn == 4) {
+            SetTimingProfile(selected);
+            EventPublish(EVENT_DB_CHANGED, 0);
+            ShowSuccess(ux->name);
+            CO_PAUSE(co, ux->infoMs);
+            CO_EXIT(co);
+        }
+    }
+    CO_END(co);
+}
+
+// "YYYY-MM-DD" and "HH:MM:SS"
+void FormatWallTime(RtccTime t, char* date, char* time) {
+    RtccDate d;
+    RtccToDate(t, &d);
+    sprintf(date, "20%02u-%02u-%02u", d.year, d.month, d.day);
+    sprintf(time, "%02u:%02u:%02u", d.hour, d.minute, d.second);
+}
+
+// Wall clock editor fields: year (2000-2099), month, day, hour, minute,
+// with their place in "20YY-MM-DD HH:MM"
+#define CLOCK_FIELDS 5
+const uint8_t clockFieldMin[CLOCK_FIELDS] = {0, 1, 1, 0, 0};
+const uint8_t clockFieldMax[CLOCK_FIELDS] = {99, 12, 31, 23, 59};
+const uint8_t clockFieldChar[CLOCK_FIELDS] = {2, 5, 8, 11, 14};
+
+void DrawClockEditor(const uint8_t* field, uint8_t selected) {
+    char line[24];
+    SetColor(BLACK);
+    ClearDevice();
+    SetColor(WHITE);
+
+    const char* title = RtccIsSet() ? "SET CLOCK" : "CLOCK NOT SET";
+    DrawString((DISP_HOR_RESOLUTION - GetStringWidth(title)) / 2, 0, title);
+
+    sprintf(line, "20%02u-%02u-%02u %02u:%02u",
+            field[0], field[1], field[2], field[3], field[4]);
+    int16_t x = (DISP_HOR_RESOLUTION - GetStringWidth(line)) / 2;
+    DrawString(x, 24, line);
+
+    // underline the two digits of the selected field
+    int16_t xField = x + 6 * clockFieldChar[selected];
+    DrawLine(xField, 34, xField + 10, 34);
+
+    DrawString(0, 56, "< > FIELD  CENTER=SET");
+}
+
+// Edit the wall clock, starting from its current value: UP/DOWN step the
+// selected field within its range (hold to repeat), RIGHT/LEFT select the
+// field, CENTER sets the clock with the seconds at 0. LEFT on the year
+// leaves without a change.
+uint8_t SetWallClock(Coroutine* co) {
+    static uint8_t field[CLOCK_FIELDS];
+    static uint8_t selected;
+    static Gesture g;
+
+    CO_BEGIN(co);
+    RtccDate d;
+    RtccToDate(RtccNow(), &d);
+    field[0] = d.year; field[1] = d.month; field[2] = d.day;
+    field[3] = d.hour; field[4] = d.minute;
+    selected = 0;
+    FlushGestures();
+
+    while (1) {
+        DrawClockEditor(field, selected);
+        CO_YIELD_UNTIL(co, GetGesture(&g) || uiTimedOut);
+        if (uiTimedOut) CO_EXIT(co);
+        if (g.type == GESTURE_LONG_PRESS) continue;
+
+        if (g.pad == 0) {           // UP
+            if (field[selected] < clockFieldMax[selected]) field[selected]++;
+        } else if (g.pad == 2) {    // DOWN
+            if (field[selected] > clockFieldMin[selected]) field[selected]--;
+        } else if (g.pad == 1) {    // RIGHT
+            if (selected < CLOCK_FIELDS - 1) selected++;
+        } else if (g.pad == 3) {    // LEFT
+            if (selected == 0) CO_EXIT(co);
+            selected--;
+        } else if (g.pad == 4) {    // CENTER
+            break;
+        }
+        // a shorter month or a common year takes the day down with it
+        uint8_t days = RtccDaysInMonth(field[0], field[1]);
+        if (field[2] > days) field[2] = days;
+    }
+
+    RtccDate set = {field[0], field[1], field[2], field[3], field[4], 0};
+    RtccSet(&set);  // every field is in range
+    ShowSuccess("CLOCK SET");
+    CO_PAUSE(co, ux->infoMs);
+    CO_END(co);
+}
+
+// Show the audit log, newest first, until a pad is pressed. With the wall
+// clock set each event shows its time of day, otherwise its age.
+uint8_t ShowAuditLog(Coroutine* co) {
+    static Coroutine sub;
+    static uint8_t btn;
+
+    CO_BEGIN(co);
+    SetColor(BLACK);
+    ClearDevice();
+    SetColor(WHITE);
+    DrawString(0, 0, RtccIsSet() ? "AUDIT TIME     ID" : "AUDIT  AGO S ID");
+
+    char line[24];
+    char date[12], time[10];
+    if (auditCount == 0) DrawString(0, 12, "NO EVENTS");
+    for (uint8_t n = 0; n < auditCount && n < 6; n++) {
+        Event* e = AuditGet(n);
+        if (RtccIsSet()) {
+            FormatWallTime(e->wall, date, time);
+            sprintf(line, "%-6s%s %05u", eventNames[e->topic], time, e->arg);
+        } else {
+            sprintf(line, "%-6s%6lu %05u", eventNames[e->topic],
+                    (millis() - e->timeMs) / 1000, e->arg);
+        }
+        DrawString(0, 10 + n * 9, line);
+    }
+
+    CO_SPAWN(co, &sub, WaitForButton(&sub, &btn));
+    CO_END(co);
+}
+
+// User store state, CENTER runs the benchmark (UserStoreBenchmark) and
+// shows its results in cycles, any other pad goes back. Built with
+// USER_STORE_SEED, RIGHT fills the store up to STORE_SEED_USERS.
+#define STORE_SEED_USERS 1000
+uint8_t ShowUserStore(Coroutine* co) {
+    static Coroutine sub;
+    static uint8_t btn;
+    static UserStoreBench bench;
+
+    CO_BEGIN(co);
+    while (1) {
+        const UserStoreStats* st = UserStoreGetStats();
+        char line[24];
+        SetColor(BLACK);
+        ClearDevice();
+        SetColor(WHITE);
+        sprintf(line, "USERS %u/%u", UserCount(), USER_KEYS);
+        DrawString(0, 0, line);
+        sprintf(line, "CACHE HIT %lu", st->hits);
+        DrawString(0, 10, line);
+        sprintf(line, "     MISS %lu", st->misses);
+        DrawString(0, 19, line);
+        sprintf(line, "PAGE WRITES %u", st->pageWrites);
+        DrawString(0, 28, line);
+        sprintf(line, "JOURNAL %u/%u", JournalUsed(), JOURNAL_WORDS);
+        DrawString(0, 37, line);
+        DrawString(0, 55, "CENTER=BENCHMARK");
+
+        CO_SPAWN(co, &sub, WaitForButton(&sub, &btn));
+#if USER_STORE_SEED
+        if (btn == 1) {
+            DisplayCentered("SEEDING...");
+            CO_YIELD(co);
+            UserStoreSeed(STORE_SEED_USERS);
+            continue;
+        }
+#endif
+        if (btn != 4) CO_EXIT(co);
+
+        DisplayCentered("MEASURING...");
+        CO_YIELD(co);
+        UserStoreBenchmark(&bench);
+
+        SetColor(BLACK);
+        ClearDevice();
+        SetColor(WHITE);
+        sprintf(line, "USERS %u", UserCount());
+        DrawString(0, 0, line);
+        DrawString(0, 10, "CYCLES    AVG     MAX");
+        sprintf(line, "FIND  %7lu%8lu", bench.findMean, bench.findMax);
+        DrawString(0, 19, line);
+        sprintf(line, "LOAD  %7lu%8lu", bench.loadMean, bench.loadMax);
+        DrawString(0, 28, line);
+        sprintf(line, "REG   %7lu%8lu", bench.putMean, bench.putMax);
+        DrawString(0, 37, line);
+        sprintf(line, "DEL   %7lu%8lu", bench.removeMean, bench.removeMax);
+        DrawString(0, 46, line);
+        sprintf(line, "%u LOADS, %u WRITES", bench.loads, bench.writes);
+        DrawString(0, 55, line);
+        CO_SPAWN(co, &sub, WaitForButton(&sub, &btn));
+        if (btn == 0xFF) CO_EXIT(co);
+    }
+    CO_END(co);
+}
+
+// profiler pages, see DrawProfilePage
+#define PROFILE_PAGE_IRQ    (PROFILE_COUNT + 1)
+#define PROFILE_PAGES       (PROFILE_PAGE_IRQ + 1 + IRQ_SITES)
+
+// Function profiler results: a summary page, then one histogram page per
+// function, then the same for the interrupt-masked windows. UP/DOWN
+// change the page, CENTER clears the results, LEFT goes back.
+uint8_t ShowProfiler(Coroutine* co) {
+    static Coroutine sub;
+    static uint8_t page;
+    static uint8_t btn;
+
+    CO_BEGIN(co);
+    page = 0;
+    while (1) {
+        DrawProfilePage(page);
+        CO_SPAWN(co, &sub, WaitForButton(&sub, &btn));
+        if (btn == 0xFF || btn == 3) CO_EXIT(co);  // timeout or LEFT
+
+        if (btn == 0) {
+            page = (page > 0) ? page - 1 : PROFILE_PAGES - 1;
+        } else if (btn == 2) {
+            page = (page < PROFILE_PAGES - 1) ? page + 1 : 0;
+        } else if (btn == 4) {
+            ProfileReset();
+            IrqMaskReset();
+        }
     }
+    CO_END(co);
 }
 
 // ==================== PATTERN DISPLAY ====================
@@ -491,6 +1160,7 @@ void DrawPatternLines(uint8_t* pattern, uint8_t length) {
 
 // Draw current pattern state (grid + lines so far)
 void UpdatePatternDisplay(uint8_t* pattern, uint8_t length) {
+    PROFILE_SCOPE(PROF_PATTERN_DISPLAY);
     SetColor(BLACK);
     ClearDevice();
     DrawPatternGrid();
@@ -525,12 +1195,15 @@ void DrawX(int16_t x, int16_t y) {
 }
 
 // Show loading animation with animated dots
-// Returns after specified duration or when interrupted
-void ShowLoadingAnimation(const char* baseText, uint16_t durationMs) {
-    uint16_t elapsed = 0;
-    uint8_t dotCount = 0;
+// Finishes after the specified duration
+uint8_t ShowLoadingAnimation(Coroutine* co, const char* baseText, uint16_t durationMs) {
+    static uint16_t elapsed;
+    static uint8_t dotCount;
     const uint16_t dotInterval = 300;  // Change dots every 300ms
     
+    CO_BEGIN(co);
+    elapsed = 0;
+    dotCount = 0;
     while (elapsed < durationMs) {
         char loadingText[20];
         uint8_t pos = 0;
@@ -550,10 +1223,11 @@ void ShowLoadingAnimation(const char* baseText, uint16_t durationMs) {
         
         DisplayCentered(loadingText);
         
-        delay(dotInterval);
+        CO_WAIT_MS(co, dotInterval);
         elapsed += dotInterval;
         dotCount++;
     }
+    CO_END(co);
 }
 
 // Show success message with checkmark
@@ -630,20 +1304,6 @@ void ShowTimingAnalysis(uint8_t* segmentMatches, uint8_t totalSegments) {
     DrawString(xPos, 58, summary);  // Moved from 56 to 58 for better spacing
 }
 
-// ==================== TIMER DELAY ====================
-void delay(unsigned int milliseconds) {
-    T1CONbits.TCKPS = 0b11; // Prescale 1:256
-    PR1 = 47; TMR1 = 0; // Reset timer counter
-    T1CONbits.TON = 1; // Turn on Timer1
-    unsigned int count = 0;
-    while (count < milliseconds) {
-        while (!IFS0bits.T1IF); // Wait for Timer1 interrupt flag
-        IFS0bits.T1IF = 0; // Clear Timer1 interrupt flag
-        count++;
-    }
-    T1CONbits.TON = 0; // Turn off Timer1
-}
-
 // ==================== UI HELPER FUNCTIONS ====================
 
 // Display text centered horizontally on screen
@@ -659,22 +1319,6 @@ void DisplayCentered(const char* text) {
     DrawString(xPos, yPos, text);
 }
 
-// Display message for specified duration (in seconds)
-void ShowMessage(const char* text, uint8_t seconds) {
-    DisplayCentered(text);
-    delay(seconds * 1000);
-}
-
-// Blink RGB LED with given color a number of times
-void BlinkRGB(uint8_t r, uint8_t g, uint8_t b, uint8_t times, uint16_t onMs, uint16_t offMs) {
-    for (uint8_t i = 0; i < times; i++) {
-        SetRGBs(r, g, b);       // LED on with requested color
-        delay(onMs);
-        SetRGBs(0, 0, 0);       // LED off
-        delay(offMs);
-    }
-}
-
 // Display two lines of text
 void DisplayTwoLines(const char* line1, const char* line2) {
     SetColor(BLACK);
@@ -744,231 +1388,342 @@ void DrawMainMenu(uint8_t screenIndex, uint8_t selectedIndex) {
         DrawString(arrowX, yCenter, ">");
         DrawLine(xRight, underlineY, xRight + widthRight, underlineY);
     }
+
+    DrawPadFaults();
+}
+
+// Show touch pads the health monitor has taken out of service (bottom line)
+void DrawPadFaults(void) {
+    uint8_t mask = PadFaultMask();
+    if (mask == 0) return;
+
+    char faultLine[22] = "PAD FAULT:";
+    uint8_t pos = 10;
+    for (uint8_t i = 0; i < NUM_TOUCHPADS; i++) {
+        if (mask & (1 << i)) {
+            faultLine[pos++] = ' ';
+            faultLine[pos++] = '1' + i;  // show as button number 1-5
+        }
+    }
+    faultLine[pos] = '\0';
+    uint8_t width = GetStringWidth(faultLine);
+    DrawString((DISP_HOR_RESOLUTION - width) / 2, 54, faultLine);
 }
 
-// Draw LIST submenu with two screens and better spacing
-// screenIndex: 0 = Screen 1 (REGISTERED, ACTIVE USERS, LOCKED), 1 = Screen 2 (DELETED, DEL USER, BACK)
-// selectedIndex: 0-2 for Screen 1, 0-2 for Screen 2
-// actualIndex: 0 = REGISTERED, 1 = ACTIVE USERS, 2 = LOCKED, 3 = DELETED, 4 = DEL USER, 5 = BACK
-void DrawListSubMenu(uint8_t screenIndex, uint8_t selectedIndex) {
+// LIST submenu items, three per screen
+#define LIST_DEL_USER   4
+#define LIST_TIMING     5
+#define LIST_PROFILER   6
+#define LIST_AUDIT      7
+#define LIST_CLOCK      8
+#define LIST_STORE      9
+#define LIST_BACK       10
+#define LIST_ITEMS      11
+
+const char* const listMenuItems[LIST_ITEMS] = {
+    "REGISTERED", "ACTIVE USERS", "LOCKED",   // 0-3 are DisplayUserList filters
+    "DELETED", "DEL USER", "TIMING",
+    "PROFILER", "AUDIT", "CLOCK",
+    "STORE", "BACK",
+};
+
+// Draw the LIST submenu screen that holds the selected item, with an arrow
+// and an underline on the selected item
+// selectedIndex: 0 to LIST_ITEMS - 1
+void DrawListSubMenu(uint8_t selectedIndex) {
     SetColor(BLACK);
     ClearDevice();
     SetColor(WHITE);
 
-    const char* regUsersText = "REGISTERED";
-    const char* loggedInText = "ACTIVE USERS";
-    const char* lockedText = "LOCKED";
-    const char* deletedText = "DELETED";
-    const char* adminDelText = "DEL USER";
-    const char* backText = "BACK";
+    // Y positions with good spacing (centered vertically)
+    const int16_t yItem[3] = {12, 28, 44};
+    uint8_t first = selectedIndex - selectedIndex % 3;
 
-    // Variables for selected option position
-    int16_t xPos, yPos;
-    uint8_t textWidth;
+    for (uint8_t i = 0; i < 3 && first + i < LIST_ITEMS; i++) {
+        const char* text = listMenuItems[first + i];
+        uint8_t textWidth = GetStringWidth(text);
+        int16_t xPos = (DISP_HOR_RESOLUTION - textWidth) / 2;
+        DrawString(xPos, yItem[i], text);
 
-    if (screenIndex == 0) {
-        // Screen 1: REGISTERED, ACTIVE USERS, LOCKED
-        // Y positions with good spacing (centered vertically)
-        const int16_t yReg = 12;
-        const int16_t yLogged = 28;
-        const int16_t yLocked = 44;
-
-        // Draw all three options
-        uint8_t widthReg = GetStringWidth(regUsersText);
-        int16_t xReg = (DISP_HOR_RESOLUTION - widthReg) / 2;
-        DrawString(xReg, yReg, regUsersText);
-
-        uint8_t widthLogged = GetStringWidth(loggedInText);
-        int16_t xLogged = (DISP_HOR_RESOLUTION - widthLogged) / 2;
-        DrawString(xLogged, yLogged, loggedInText);
-
-        uint8_t widthLocked = GetStringWidth(lockedText);
-        int16_t xLocked = (DISP_HOR_RESOLUTION - widthLocked) / 2;
-        DrawString(xLocked, yLocked, lockedText);
-
-        // Get selected option position
-        if (selectedIndex == 0) {
-            xPos = xReg;
-            yPos = yReg;
-            textWidth = widthReg;
-        } else if (selectedIndex == 1) {
-            xPos = xLogged;
-            yPos = yLogged;
-            textWidth = widthLogged;
-        } else {  // selectedIndex == 2
-            xPos = xLocked;
-            yPos = yLocked;
-            textWidth = widthLocked;
-        }
-    } else {
-        // Screen 2: DELETED, DEL USER, BACK
-        // Y positions with good spacing (centered vertically)
-        const int16_t yDeleted = 12;
-        const int16_t yAdminDel = 28;
-        const int16_t yBack = 44;
-
-        // Draw all three options
-        uint8_t widthDeleted = GetStringWidth(deletedText);
-        int16_t xDeleted = (DISP_HOR_RESOLUTION - widthDeleted) / 2;
-        DrawString(xDeleted, yDeleted, deletedText);
-
-        uint8_t widthAdminDel = GetStringWidth(adminDelText);
-        int16_t xAdminDel = (DISP_HOR_RESOLUTION - widthAdminDel) / 2;
-        DrawString(xAdminDel, yAdminDel, adminDelText);
-
-        uint8_t widthBack = GetStringWidth(backText);
-        int16_t xBack = (DISP_HOR_RESOLUTION - widthBack) / 2;
-        DrawString(xBack, yBack, backText);
-
-        // Get selected option position
-        if (selectedIndex == 0) {
-            xPos = xDeleted;
-            yPos = yDeleted;
-            textWidth = widthDeleted;
-        } else if (selectedIndex == 1) {
-            xPos = xAdminDel;
-            yPos = yAdminDel;
-            textWidth = widthAdminDel;
-        } else {  // selectedIndex == 2 (BACK)
-            xPos = xBack;
-            yPos = yBack;
-            textWidth = widthBack;
+        if (first + i == selectedIndex) {
+            // Draw arrow on the left side (">" symbol)
+            const int16_t arrowX = 8;
+            DrawString(arrowX, yItem[i], ">");
+
+            // Draw underline below the selected text
+            const int16_t underlineY = yItem[i] + 12;  // Below the text
+            DrawLine(xPos, underlineY, xPos + textWidth, underlineY);
         }
     }
+}
 
-    // Draw underline and arrow indicator for selected option
-    // Draw arrow on the left side (">" symbol)
-    const int16_t arrowX = 8;
-    DrawString(arrowX, yPos, ">");
-    
-    // Draw underline below the selected text
-    const int16_t underlineY = yPos + 12;  // Below the text
-    const int16_t underlineStartX = xPos;
-    const int16_t underlineEndX = xPos + textWidth;
-    DrawLine(underlineStartX, underlineY, underlineEndX, underlineY);
+// Draw the timing profiles with their average transaction time (s) and
+// number of transactions, ">" = selected, "*" = in use
+void DrawTimingProfiles(uint8_t selectedIndex) {
+    SetColor(BLACK);
+    ClearDevice();
+    SetColor(WHITE);
+    DrawString(0, 0, "  PROFILE   AVG S  N");
+
+    char line[24];
+    for (uint8_t i = 0; i < TIMING_PROFILES; i++) {
+        uint32_t avg = AverageTransactionMs(i);
+        sprintf(line, "%c%c%-10s%3lu.%lu%3u",
+                (i == selectedIndex) ? '>' : ' ',
+                (i == timingProfile) ? '*' : ' ',
+                timingProfiles[i].name, avg / 1000, (avg % 1000) / 100,
+                timingStats[i].transactions);
+        DrawString(0, 16 + i * 14, line);
+    }
 }
 
-// Display list of users based on filter type
-// filterType: 0 = all registered, 1 = logged in, 2 = locked, 3 = deleted
-void DisplayUserList(uint8_t filterType) {
+// ProfileCycles() counts CLOCK_HIGH cycles at any clock speed
+#define CYCLES_PER_US   (CLOCK_FCY_HIGH / 1000000UL)
+
+// Profiler pages: min/mean/max in us per function, a log2 histogram per
+// function, then the same for the interrupt-masked windows (IrqMask.h)
+// with the number of windows over budget
+
+void DrawProfilePage(uint8_t page) {
+    char line[24];
+
     SetColor(BLACK);
     ClearDevice();
     SetColor(WHITE);
-    
-    // Set header based on filter type
-    const char* header = "";
-    if (filterType == 0) {
-        header = "REGISTERED:";
-    } else if (filterType == 1) {
-        header = "ACTIVE USERS:";
-    } else if (filterType == 2) {
-        header = "LOCKED:";
-    } else {
-        header = "DELETED:";
+
+    if (page == 0) {
+        DrawString(0, 0, "US      MIN  AVG  MAX");
+        for (uint8_t id = 0; id < PROFILE_COUNT; id++) {
+            ProfileEntry* e = ProfileGet(id);
+            if (e->count == 0) {
+                sprintf(line, "%-6s    -    -    -", e->name);
+            } else {
+                sprintf(line, "%-6s%5lu%5lu%5lu", e->name,
+                        e->minCycles / CYCLES_PER_US,
+                        ProfileMeanCycles(id) / CYCLES_PER_US,
+                        e->maxCycles / CYCLES_PER_US);
+            }
+            DrawString(0, 8 + id * 7, line);
+        }
+        return;
     }
-    
-    uint8_t headerWidth = GetStringWidth(header);
-    int16_t xHeader = (DISP_HOR_RESOLUTION - headerWidth) / 2;
-    DrawString(xHeader, 4, header);
-    
-    // Count and display users
-    uint8_t displayCount = 0;
-    uint8_t shownCount = 0;
-    
-    for (uint8_t i = 0; i < MAX_USERS && shownCount < 4; i++) {
-        uint8_t shouldDisplay = 0;
-        
+
+    if (page == PROFILE_PAGE_IRQ) {
+        sprintf(line, "IRQ OFF  MAX US  >%u", IRQ_MASK_BUDGET_US);
+        DrawString(0, 0, line);
+        for (uint8_t site = 0; site < IRQ_SITES; site++) {
+            ProfileEntry* e = IrqMaskGet(site);
+            sprintf(line, "%-6s%5lu.%lu%5u", e->name,
+                    e->maxCycles / CYCLES_PER_US,
+                    (e->maxCycles % CYCLES_PER_US) * 10 / CYCLES_PER_US,
+                    IrqMaskOverruns(site));
+            DrawString(0, 10 + site * 9, line);
+        }
+        // the CTMU site's static bound holds if the loop is within it,
+        // CTMUInit counted an overrun if not
+        sprintf(line, "LOOP %u CYC %s BOUND %u", TouchChargeLoopCycles(),
+                (TouchChargeLoopCycles() > CHARGE_LOOP_CYCLES) ? ">" : "<=",
+                CHARGE_LOOP_CYCLES);
+        DrawString(0, 10 + IRQ_SITES * 9, line);
+        return;
+    }
+
+    ProfileEntry* e = (page < PROFILE_PAGE_IRQ) ? ProfileGet(page - 1) :
+        IrqMaskGet(page - PROFILE_PAGE_IRQ - 1);
+    sprintf(line, "%-6s N %lu", e->name, e->count);
+    DrawString(0, 0, line);
+
+    uint16_t most = 1;
+    for (uint8_t i = 0; i < PROFILE_BUCKETS; i++) {
+        if (e->histogram[i] > most) most = e->histogram[i];
+    }
+    // bucket i at x = 4 + 6 * i, bars up to 40 pixels high
+    for (uint8_t i = 0; i < PROFILE_BUCKETS; i++) {
+        if (e->histogram[i] == 0) continue;
+        int16_t h = (uint32_t)e->histogram[i] * 40 / most;
+        if (h == 0) h = 1;
+        for (uint8_t dx = 0; dx < 4; dx++) {
+            DrawLine(4 + 6 * i + dx, 53 - h, 4 + 6 * i + dx, 53);
+        }
+    }
+    DrawString(10, 56, "1");        // bucket 1: 1 cycle
+    DrawString(68, 56, "1K");       // bucket 11: 1024 cycles
+    DrawString(104, 56, "256K");    // last bucket
+}
+
+// Display list of users based on filter type
+// filterType: 0 = all registered, 1 = logged in, 2 = locked, 3 = deleted
+// Registered and logged-in users are shown USER_LIST_LINES at a time with
+// the page number: UP/DOWN turn the page (wrapping unless held), a double
+// tap jumps to the first/last page, any other pad goes back.
+#define USER_LIST_LINES 4
+uint8_t DisplayUserList(Coroutine* co, uint8_t filterType) {
+    static Coroutine sub;
+    static uint8_t btn;
+    static uint16_t page;
+    static uint16_t pages;
+    static uint16_t total;
+    static Gesture g;
+
+    CO_BEGIN(co);
+    ApplyTimePolicies();
+    page = 0;
+
+    while (1) {
+        SetColor(BLACK);
+        ClearDevice();
+        SetColor(WHITE);
+
+        // Set header based on filter type
+        const char* header = "";
         if (filterType == 0) {
-            // Show all registered users
-            shouldDisplay = userDatabase[i].isActive;
+            header = "REGISTERED:";
         } else if (filterType == 1) {
-            // Show logged in users
-            shouldDisplay = userDatabase[i].isActive && userDatabase[i].isLoggedIn;
+            header = "ACTIVE USERS:";
         } else if (filterType == 2) {
-            // Show locked users (3 failed attempts)
-            shouldDisplay = userDatabase[i].isActive && userDatabase[i].failedAttempts >= 3;
+            header = "LOCKED:";
         } else {
-            // Deleted users - these are removed from database, so show message
-            shouldDisplay = 0;
+            header = "DELETED:";
         }
-        
-        if (shouldDisplay) {
-            char userLine[20];
-            sprintf(userLine, "ID: %02d", userDatabase[i].userId);
-            DrawString(8, 18 + displayCount * 12, userLine);
-            displayCount++;
-            shownCount++;
-        }
-    }
-    
-    // Handle special cases - show appropriate messages when no users found
-    if (filterType == 3) {
-        if (deletedCount == 0) {
-            DrawString(8, 18, "NO DELETED");
-            DrawString(8, 30, "HISTORY");
-        } else {
-            uint8_t show = (deletedCount > 4) ? 4 : deletedCount;
-            for (uint8_t d = 0; d < show; d++) {
-                char delLine[20];
-                sprintf(delLine, "ID: %02d", deletedHistory[d]);
-                DrawString(8, 18 + d * 12, delLine);
-            }
-        }
-    } else if (shownCount == 0 && displayCount == 0) {
-        // No users found for this filter - show specific message
+
+        uint8_t headerWidth = GetStringWidth(header);
+        int16_t xHeader = (DISP_HOR_RESOLUTION - headerWidth) / 2;
+        DrawString(xHeader, 4, header);
+
+        // registered users in ID order and logged-in users from the session
+        // table, the lines of this page; locked users are browsed in
+        // DisplayLockedUsersWithNavigation, deleted users are not in the
+        // database, they come from the history below
+        uint8_t shownCount = 0;
+        uint16_t index = 0;
+        char userLine[20];
+        total = 0;
         if (filterType == 0) {
-            // REGISTERED users
-            DrawString(8, 18, "NO USERS ARE");
-            DrawString(8, 30, "CURRENTLY");
-            DrawString(8, 42, "REGISTERED");
+            total = UserCount();
+            for (UserKey key = UserNext(USER_SET_USED, 0);
+                    key != USER_NONE && shownCount < USER_LIST_LINES;
+                    key = UserNext(USER_SET_USED, key + 1)) {
+                if (index++ < page * USER_LIST_LINES) continue;
+                sprintf(userLine, "ID: %05u", UserIdOf(key));
+                DrawString(8, 18 + shownCount * 12, userLine);
+                shownCount++;
+            }
         } else if (filterType == 1) {
-            // ACTIVE USERS
-            DrawString(8, 18, "NO USERS ARE");
-            DrawString(8, 30, "CURRENTLY");
-            DrawString(8, 42, "ACTIVE");
+            for (uint8_t i = 0; i < SESSION_SLOTS; i++) {
+                if (sessions[i].key == USER_NONE) continue;
+                total++;
+                if (index++ < page * USER_LIST_LINES
+                        || shownCount >= USER_LIST_LINES) continue;
+                sprintf(userLine, "ID: %05u", UserIdOf(sessions[i].key));
+                DrawString(8, 18 + shownCount * 12, userLine);
+                shownCount++;
+            }
         } else if (filterType == 2) {
-            // LOCKED users
+            total = (UserNext(USER_SET_LOCKED, 0) != USER_NONE);
+        }
+        pages = (total + USER_LIST_LINES - 1) / USER_LIST_LINES;
+        if (pages > 1) {
+            sprintf(userLine, "%u/%u", page + 1, pages);
+            DrawString(DISP_HOR_RESOLUTION - GetStringWidth(userLine), 54, userLine);
+        }
+
+        // Handle special cases - show appropriate messages when no users found
+        if (filterType == 3) {
+            if (deletedCount == 0) {
+                DrawString(8, 18, "NO DELETED");
+                DrawString(8, 30, "HISTORY");
+            } else {
+                uint8_t show = (deletedCount > 4) ? 4 : deletedCount;
+                for (uint8_t d = 0; d < show; d++) {
+                    char delLine[20];
+                    sprintf(delLine, "ID: %05u", deletedHistory[d]);
+                    DrawString(8, 18 + d * 12, delLine);
+                }
+            }
+        } else if (total == 0) {
+            // No users found for this filter - show specific message
             DrawString(8, 18, "NO USERS ARE");
             DrawString(8, 30, "CURRENTLY");
-            DrawString(8, 42, "LOCKED");
+            if (filterType == 0) {
+                DrawString(8, 42, "REGISTERED");
+            } else if (filterType == 1) {
+                DrawString(8, 42, "ACTIVE");
+            } else {
+                DrawString(8, 42, "LOCKED");
+            }
+        }
+
+        // For LOCKED users, use interactive navigation
+        if (filterType == 2 && total > 0) {
+            CO_SPAWN(co, &sub, DisplayLockedUsersWithNavigation(&sub));
+            CO_EXIT(co);
+        }
+        // A single page, just wait for a button to return
+        if (pages <= 1) {
+            CO_PAUSE(co, ux->infoMs);
+            CO_SPAWN(co, &sub, WaitForButton(&sub, &btn));
+            CO_EXIT(co);
+        }
+
+        CO_YIELD_UNTIL(co, GetGesture(&g) || uiTimedOut);
+        if (uiTimedOut) CO_EXIT(co);
+        if (g.type == GESTURE_DOUBLE_TAP && g.pad == 0) {
+            page = 0;
+        } else if (g.type == GESTURE_DOUBLE_TAP && g.pad == 2) {
+            page = pages - 1;
+        } else if (g.pad == 0) {    // UP
+            if (page > 0) {
+                page--;
+            } else if (g.type != GESTURE_REPEAT) {
+                page = pages - 1;
+            }
+        } else if (g.pad == 2) {    // DOWN
+            if (page < pages - 1) {
+                page++;
+            } else if (g.type != GESTURE_REPEAT) {
+                page = 0;
+            }
+        } else {
+            CO_EXIT(co);
         }
     }
-    
-    // For LOCKED users, use interactive navigation
-    if (filterType == 2 && shownCount > 0) {
-        // Use interactive navigation for locked users
-        DisplayLockedUsersWithNavigation();
-    } else {
-        // For other filter types, just wait for button to return
-        delay(2000);
-        WaitForButton();
-    }
+    CO_END(co);
 }
 
-// Display locked users with navigation and unlock option
-void DisplayLockedUsersWithNavigation(void) {
+// Display locked users with navigation and unlock option; the first
+// LOCKED_LIST_MAX locked users by ID, the others after these are unlocked
+#define LOCKED_LIST_MAX 32
+uint8_t DisplayLockedUsersWithNavigation(Coroutine* co) {
+    static Coroutine sub;
+    static uint16_t lockedUserIds[LOCKED_LIST_MAX];
+    static uint8_t lockedCount;
+    static uint8_t selectedIndex;   // Currently selected user in the list
+    static uint8_t inNavigation;
+    static Gesture g;
+    static uint16_t userIdToUnlock;
+    static uint8_t confirmBtn;
+
+    CO_BEGIN(co);
+    ApplyTimePolicies();
     // First, collect all locked user IDs into an array
-    int16_t lockedUserIds[MAX_USERS];
-    uint8_t lockedCount = 0;
-    
-    for (uint8_t i = 0; i < MAX_USERS; i++) {
-        if (userDatabase[i].isActive && userDatabase[i].failedAttempts >= 3) {
-            lockedUserIds[lockedCount] = userDatabase[i].userId;
-            lockedCount++;
-        }
+    lockedCount = 0;
+    for (UserKey key = UserNext(USER_SET_LOCKED, 0);
+            key != USER_NONE && lockedCount < LOCKED_LIST_MAX;
+            key = UserNext(USER_SET_LOCKED, key + 1)) {
+        lockedUserIds[lockedCount++] = UserIdOf(key);
     }
     
     if (lockedCount == 0) {
         // No locked users - should not reach here, but handle it
         DisplayTwoLines("NO USERS ARE", "CURRENTLY LOCKED");
-        delay(2000);
-        WaitForButton();
-        return;
+        CO_PAUSE(co, ux->infoMs);
+        CO_SPAWN(co, &sub, WaitForButton(&sub, &confirmBtn));
+        CO_EXIT(co);
     }
     
     // Navigation variables
-    uint8_t selectedIndex = 0;  // Currently selected user in the list
-    uint8_t inNavigation = 1;
+    selectedIndex = 0;
+    inNavigation = 1;
     
     while (inNavigation) {
         SetColor(BLACK);
@@ -992,7 +1747,7 @@ void DisplayLockedUsersWithNavigation(void) {
         uint8_t maxDisplay = (lockedCount > 3) ? 3 : lockedCount;
         for (uint8_t i = startIndex; i < lockedCount && displayCount < maxDisplay; i++) {
             char userLine[20];
-            sprintf(userLine, "ID: %02d", lockedUserIds[i]);
+            sprintf(userLine, "ID: %05u", lockedUserIds[i]);
             
             int16_t yPos = 16 + displayCount * 12;
             DrawString(8, yPos, userLine);
@@ -1017,43 +1772,52 @@ void DisplayLockedUsersWithNavigation(void) {
         int16_t instX = (DISP_HOR_RESOLUTION - instWidth) / 2;
         DrawString(instX, 56, instructionText);
         
-        // Wait for button input
-        uint8_t btn = WaitForButton();
+        // Wait for input: holding UP/DOWN scrolls (no wrap while held), a
+        // double tap jumps to the first/last user, a long press on CENTER 
+        // unlocks without the confirmation screen
+        CO_YIELD_UNTIL(co, GetGesture(&g) || uiTimedOut);
+        if (uiTimedOut) CO_EXIT(co);
+        uint8_t btn = g.pad;
         
-        if (btn == 0) {          // UP
+        if (g.type == GESTURE_DOUBLE_TAP && btn == 0) {
+            selectedIndex = 0;
+        } else if (g.type == GESTURE_DOUBLE_TAP && btn == 2) {
+            selectedIndex = lockedCount - 1;
+        } else if (btn == 0) {          // UP
             if (selectedIndex > 0) {
                 selectedIndex--;
-            } else {
+            } else if (g.type != GESTURE_REPEAT) {
                 // Wrap to bottom
                 selectedIndex = lockedCount - 1;
             }
         } else if (btn == 2) {   // DOWN
             if (selectedIndex < lockedCount - 1) {
                 selectedIndex++;
-            } else {
+            } else if (g.type != GESTURE_REPEAT) {
                 // Wrap to top
                 selectedIndex = 0;
             }
         } else if (btn == 4) {   // CENTER = unlock selected user
             // Confirm unlock
-            int16_t userIdToUnlock = lockedUserIds[selectedIndex];
-            
-            // Show confirmation
-            char confirmMsg[30];
-            sprintf(confirmMsg, "UNLOCK ID %02d?", userIdToUnlock);
-            DisplayTwoLines(confirmMsg, "CENTER=YES");
-            delay(2000);
+            userIdToUnlock = lockedUserIds[selectedIndex];
+            confirmBtn = 4;
             
-            // Wait for confirmation
-            uint8_t confirmBtn = WaitForButton();
+            if (g.type != GESTURE_LONG_PRESS) {
+                // Show confirmation
+                char confirmMsg[30];
+                sprintf(confirmMsg, "UNLOCK ID %05u?", userIdToUnlock);
+                DisplayTwoLines(confirmMsg, "CENTER=YES");
+                CO_PAUSE(co, ux->infoMs);
+                
+                // Wait for confirmation
+                CO_SPAWN(co, &sub, WaitForButton(&sub, &confirmBtn));
+            }
             if (confirmBtn == 4) {  // CENTER = confirm
                 // Unlock the user
-                if (UnlockUser(userIdToUnlock)) {
-                    FlashWriteDatabase();
-                    ShowLoadingAnimation("UNLOCKING", 1000);
-                    BlinkRGB(0, 255, 0, 3, 200, 200);
+                if (UnlockUser(userIdToUnlock)) {  // GREEN blink, commit on the event
+                    CO_SPAWN(co, &sub, ShowLoadingAnimation(&sub, "UNLOCKING", ux->checkMs));
                     ShowSuccess("USER UNLOCKED");
-                    delay(2000);
+                    CO_PAUSE(co, ux->infoMs);
                     
                     // Remove unlocked user from list
                     // Shift array to remove unlocked user
@@ -1071,12 +1835,12 @@ void DisplayLockedUsersWithNavigation(void) {
                     if (lockedCount == 0) {
                         inNavigation = 0;
                         DisplayTwoLines("ALL USERS", "UNLOCKED");
-                        delay(2000);
+                        CO_PAUSE(co, ux->infoMs);
                     }
                 } else {
-                    BlinkRGB(255, 0, 0, 3, 200, 200);
+                    RGBBlink(255, 0, 0, ux->blinks, ux->blinkMs, ux->blinkMs);
                     ShowError("UNLOCK FAILED");
-                    delay(2000);
+                    CO_PAUSE(co, ux->infoMs);
                 }
             }
             // If not confirmed, continue navigation
@@ -1085,6 +1849,179 @@ void DisplayLockedUsersWithNavigation(void) {
         }
         // Other buttons (1=RIGHT) are ignored
     }
+    CO_END(co);
+}
+
+// ==================== BOOT TIMING ====================
+
+// Boot phases in micros() since the tick started. The panel power-up and
+// the touch warm-up run in the background, so phases overlap; the tracked
+// figure is bootUsableUs, the time until a touch is acted on (warm-up
+// over and the first screen flushed to the panel).
+#define BOOT_CORE       0   // profiler, RTCC and timer wheel
+#define BOOT_PANEL_ON   1   // panel configuration, DC-DC on
+#define BOOT_CTMU       2
+#define BOOT_LEDS       3
+#define BOOT_FLASH      4   // database load
+#define BOOT_PANEL      5   // panel power-up wait, background
+#define BOOT_WARMUP     6   // touch warm-up, background
+#define BOOT_PHASES     7
+
+typedef struct {
+    const char* name;
+    uint32_t startUs;
+    uint32_t us;
+} BootPhase;
+
+BootPhase bootPhases[BOOT_PHASES] = {
+    {"CORE"}, {"PANEL"}, {"CTMU"}, {"LEDS"}, {"FLASH"}, {"PWRUP"}, {"WARMUP"},
+};
+uint32_t bootUsableUs = 0;     // 0 = touch not usable yet
+SoftTimer panelTimer;
+
+void BootBegin(uint8_t phase) {
+    bootPhases[phase].startUs = micros();
+}
+
+void BootEnd(uint8_t phase) {
+    bootPhases[phase].us = micros() - bootPhases[phase].startUs;
+}
+
+// DISPLAY_POWERUP_MS after DisplayPowerUp(), timer callback
+static void PanelPoweredUp(SoftTimer* t) {
+    DisplayStart();
+    BootEnd(BOOT_PANEL);
+}
+
+// Called after each scan and each flush until touch is usable
+static void BootCheckTouch(void) {
+    if (!TouchReady()) return;
+    if (bootPhases[BOOT_WARMUP].us == 0) BootEnd(BOOT_WARMUP);
+    if (DisplayShown()) bootUsableUs = micros();
+}
+
+// DisplayFlush, plus the boot check: the first screen may be the last
+// thing the kiosk waits for
+void DisplayTask(void) {
+    DisplayFlush();
+    if (bootUsableUs == 0) BootCheckTouch();
+}
+
+// ==================== TOUCH TASK ====================
+
+// Touch state shared by the input functions, updated on every scan
+#define TOUCH_THRESHOLD         6   // aggregate needed to count as touched
+#define TOUCH_RELEASE_THRESHOLD 2   // all aggregates at or below = released
+#define GESTURE_QUEUE_SIZE      4   // must be a power of 2
+
+int16_t touchAggr[5] = {0, 0, 0, 0, 0};
+uint8_t activePad = 0xFF;      // pad with the highest aggregate, 0xFF = none
+uint8_t touchReleased = 1;     // 1 = every pad fully released
+uint16_t touchScans = 0;       // incremented after every scan
+
+Gesture gestureQueue[GESTURE_QUEUE_SIZE];  // oldest dropped when full
+uint8_t gestureHead = 0;
+uint8_t gestureTail = 0;
+uint8_t gestureArmed = 1;      // 0 = ignore the pads until all are released
+
+// Scan the pads, debounce them into touchAggr and feed the gesture recognizer
+void TouchTask(void) {
+    ReadCTMU();
+    if (bootUsableUs == 0) BootCheckTouch();
+
+    // Update aggregate values
+    for (uint8_t i = 0; i < 5; i++) {
+        if (buttons[i]) touchAggr[i]++;
+        else touchAggr[i]--;
+        if (touchAggr[i] < 0) touchAggr[i] = 0;
+        if (touchAggr[i] > 30) touchAggr[i] = 30;
+    }
+
+    // Find highest aggregate button, check for full release
+    int16_t maxVal = TOUCH_THRESHOLD;
+    uint8_t maxButton = 0xFF;
+    uint8_t allReleased = 1;
+    for (uint8_t i = 0; i < 5; i++) {
+        if (touchAggr[i] > maxVal) {
+            maxVal = touchAggr[i];
+            maxButton = i;
+        }
+        if (touchAggr[i] > TOUCH_RELEASE_THRESHOLD) allReleased = 0;
+    }
+    activePad = maxButton;
+    touchReleased = allReleased;
+    if (maxButton != 0xFF) UserActivity();
+
+    Gesture g;
+    if (!gestureArmed) {
+        gestureArmed = (maxButton == 0xFF);
+    } else if (GestureUpdate(maxButton, (uint16_t)millis(), &g)) {
+        gestureQueue[gestureHead] = g;
+        gestureHead = (gestureHead + 1) & (GESTURE_QUEUE_SIZE - 1);
+        if (gestureHead == gestureTail) {
+            gestureTail = (gestureTail + 1) & (GESTURE_QUEUE_SIZE - 1);
+        }
+    }
+
+    touchScans++;
+}
+
+// Wait in a coroutine until the touch task has done its next scan, scan
+// must be a static uint16_t of the caller
+#define CO_WAIT_TOUCH_SCAN(co, scan) \
+    do { scan = touchScans; CO_YIELD_UNTIL(co, touchScans != scan); } while (0)
+
+// Take the oldest recognized gesture, returns 0 if there is none
+uint8_t GetGesture(Gesture* g) {
+    if (gestureHead == gestureTail) return 0;
+    *g = gestureQueue[gestureTail];
+    gestureTail = (gestureTail + 1) & (GESTURE_QUEUE_SIZE - 1);
+    return 1;
+}
+
+// Drop queued gestures and ignore the touch in progress. Called when a flow
+// returns so its last touches are not taken as menu input.
+void FlushGestures(void) {
+    gestureHead = gestureTail = 0;
+    GestureReset();
+    gestureArmed = 0;
+}
+
+// ==================== SKIPPABLE PAUSES ====================
+
+uint32_t pauseStart;
+uint16_t pauseMs;
+uint8_t pauseArmed;            // 0 = a pad was held when the pause started
+uint8_t pauseTouched;          // 1 = touched since armed
+uint16_t pauseSkips = 0;       // pauses cut short
+uint32_t pauseSkippedMs = 0;   // wall time saved by skipping
+
+void PauseStart(uint16_t ms) {
+    pauseStart = millis();
+    pauseMs = ms;
+    pauseArmed = touchReleased;
+    pauseTouched = 0;
+}
+
+// The pause ends when its time is up or when a pad is touched and released
+// again; the release is waited for so the touch does not carry over into
+// the next screen. A pad already held when the pause started is ignored
+// until it is released.
+uint8_t PauseDone(void) {
+    uint32_t elapsed = millis() - pauseStart;
+    if (elapsed >= pauseMs) return 1;
+
+    if (!pauseArmed) {
+        pauseArmed = touchReleased;
+    } else if (activePad != 0xFF) {
+        pauseTouched = 1;
+    } else if (pauseTouched && touchReleased) {
+        pauseSkips++;
+        pauseSkippedMs += pauseMs - elapsed;
+        FlushGestures();  // the tap was only meant to skip
+        return 1;
+    }
+    return 0;
 }
 
 // ==================== PATTERN INPUT ====================
@@ -1098,133 +2035,124 @@ uint8_t IsInPattern(uint8_t* pattern, uint8_t length, uint8_t button) {
 }
 
 // Collect pattern using swipe detection (like ball movement)
-// Also captures timing between button presses in milliseconds
-void CollectPattern(uint8_t* pattern, uint16_t* timing) {
-    uint8_t patternLen = 0;
-    int16_t aggr[5] = {0, 0, 0, 0, 0};
-    uint8_t lastButton = 0xFF;
-    const int16_t THRESHOLD = 6;
-    const uint16_t timeout = 10;
-
-    uint32_t lastButtonTime = 0;
-    uint32_t currentTime = 0;
-
+// Also captures timing between button presses in milliseconds, taken from
+// the timestamps of the scans in which the pads were first touched
+uint8_t CollectPattern(Coroutine* co, uint8_t* pattern, uint16_t* timing) {
+    static uint8_t patternLen;
+    static uint8_t lastButton;
+    static uint32_t lastButtonTime;
+    static uint32_t pressTime[5];  // timestamp of each pad's latest touch
+    static uint32_t holdStart;
+    static uint16_t scan;
+    TouchEvent event;
+
+    CO_BEGIN(co);
+    patternLen = 0;
+    lastButton = 0xFF;
+    lastButtonTime = 0;
     for (uint8_t i = 0; i < PATTERN_LENGTH - 1; i++) {
         timing[i] = 0;
     }
+    TouchFlushEvents();
+    for (uint8_t i = 0; i < 5; i++) {
+        pressTime[i] = micros();
+    }
 
     // Show initial grid
     SetColor(BLACK);
     ClearDevice();
     DrawPatternGrid();
-    
+    SwipeStart();  // dwell/transition/velocity features go to 'swipe'
+
     // Collect pattern until 5 buttons
     while (patternLen < PATTERN_LENGTH) {
-        ReadCTMU();
-        
-        // Update aggregate values (same as ball movement logic)
-        for (uint8_t i = 0; i < 5; i++) {
-            if (buttons[i]) aggr[i]++;
-            else aggr[i]--;
-            if (aggr[i] < 0) aggr[i] = 0;
-            if (aggr[i] > 30) aggr[i] = 30;
+        CO_WAIT_TOUCH_SCAN(co, scan);
+        while (TouchGetEvent(&event)) {
+            if (event.pressed) pressTime[event.pad] = event.time;
         }
-        
-        // Find which button currently has highest aggregate
-        int16_t maxVal = THRESHOLD;
-        uint8_t currentButton = 0xFF;
-        for (uint8_t i = 0; i < 5; i++) {
-            if (aggr[i] > maxVal) {
-                maxVal = aggr[i];
-                currentButton = i;
-            }
-        }
-        
+
+        // Button with the highest aggregate (same as ball movement logic)
+        uint8_t currentButton = activePad;
+
+        SwipeUpdate(currentButton, (uint16_t)millis());
+
         // If touching a valid button
         if (currentButton != 0xFF) {
             uint8_t buttonNum = currentButton + 1;  // Convert 0-4 to 1-5
-            
+
             // Check if it's a NEW button (not the same as last, not already in pattern)
             if (currentButton != lastButton && !IsInPattern(pattern, patternLen, buttonNum)) {
                 // Calculate timing since last button (if not first button)
                 if (patternLen > 0) {
-                    // Time difference in loop iterations, convert to milliseconds
-                    uint32_t timeDiff = currentTime - lastButtonTime;
-                    timing[patternLen - 1] = (uint16_t)(timeDiff * timeout);  // Convert to milliseconds
+                    // Time between the two touches, convert to milliseconds
+                    uint32_t timeDiff = pressTime[currentButton] - lastButtonTime;
+                    timing[patternLen - 1] = (uint16_t)(timeDiff / 1000);
                 }
-                
+
                 // Add to pattern
                 pattern[patternLen] = buttonNum;
                 patternLen++;
                 lastButton = currentButton;
-                lastButtonTime = currentTime;  // Record time when this button was added
-                
+                lastButtonTime = pressTime[currentButton];  // touch time of this button
+
+                // Scan the pads that can still come next (plus the current
+                // one, for its dwell time) more often than the used ones
+                uint8_t focus = 1 << currentButton;
+                for (uint8_t i = 0; i < 5; i++) {
+                    if (!IsInPattern(pattern, patternLen, i + 1)) focus |= 1 << i;
+                }
+                TouchSetFocus(focus);
+
                 // Update display with new line
                 UpdatePatternDisplay(pattern, patternLen);
             }
         }
-        
-        delay(timeout);
-        currentTime++;  // Increment time counter
     }
-    
-    // Pattern complete - show final result for a moment
-    delay(500);
+
+    // Pattern complete - show final result for a moment, keep tracking the
+    // last pad meanwhile so its dwell time is known
+    holdStart = millis();
+    while (!TIME_ELAPSED(holdStart, 500)) {
+        CO_WAIT_TOUCH_SCAN(co, scan);
+        SwipeUpdate(buttons[lastButton] ? lastButton : 0xFF, (uint16_t)millis());
+    }
+    SwipeFinish();
+    TouchSetFocus(0);
+    FlushGestures();
+    CO_END(co);
 }
 
 // ==================== INPUT COLLECTION ====================
 
-// Collect multi-digit number from button presses
-int16_t CollectDigits(uint8_t numDigits, const char* prompt) {
-    char input[10] = {0};
+// Collect multi-digit number from button presses into *result
+uint8_t CollectDigits(Coroutine* co, uint8_t numDigits, const char* prompt, uint16_t* result) {
+    static char input[10];
     char display[30] = {0};
-    uint8_t digitCount = 0;
-    int16_t aggr[5] = {0, 0, 0, 0, 0};
-    uint8_t digitRegistered = 0; // Flag to prevent multiple registration
-    const int16_t THRESHOLD = 6;
-    const int16_t RELEASE_THRESHOLD = 2; // More strict release detection
-    const uint16_t timeout = 10;
+    static uint8_t digitCount;
+    static uint8_t digitRegistered; // Flag to prevent multiple registration
+    static uint16_t scan;
+
+    CO_BEGIN(co);
+    for (uint8_t i = 0; i < sizeof(input); i++) {
+        input[i] = 0;
+    }
+    digitCount = 0;
+    // A pad still held from the previous screen has to be released first
+    digitRegistered = !touchReleased;
 
     while (digitCount < numDigits) {
-        ReadCTMU();
-
-        // Update aggregate values
-        for (uint8_t i = 0; i < 5; i++) {
-            if (buttons[i]) aggr[i]++;
-            else aggr[i]--;
-            if (aggr[i] < 0) aggr[i] = 0;
-            if (aggr[i] > 30) aggr[i] = 30;
-}
-
-        // Check if all buttons are truly released (all aggregates near zero)
-        uint8_t allReleased = 1;
-        for (uint8_t i = 0; i < 5; i++) {
-            if (aggr[i] > RELEASE_THRESHOLD) {
-                allReleased = 0;
-                break;
-            }
-        }
+        CO_WAIT_TOUCH_SCAN(co, scan);
 
         // Reset flag when fully released
-        if (allReleased && digitRegistered) {
+        if (touchReleased && digitRegistered) {
             digitRegistered = 0;
         }
 
         // Only process new digit if not already registered
         if (!digitRegistered) {
-            // Find highest aggregate button
-            int16_t maxVal = THRESHOLD;
-            uint8_t maxButton = 0xFF;
-            for (uint8_t i = 0; i < 5; i++) {
-                if (aggr[i] > maxVal) {
-                    maxVal = aggr[i];
-                    maxButton = i;
-                }
-            }
-
             // Register digit if button detected
-            if (maxButton != 0xFF) {
-                uint8_t digit = maxButton + 1; // Map buttons 0-4 to digits 1-5
+            if (activePad != 0xFF) {
+                uint8_t digit = activePad + 1; // Map buttons 0-4 to digits 1-5
                 input[digitCount] = '0' + digit;
                 digitCount++;
 
@@ -1235,105 +2163,547 @@ int16_t CollectDigits(uint8_t numDigits, const char* prompt) {
                 digitRegistered = 1; // Lock further input until full release
             }
         }
-
-        delay(timeout);
     }
 
     // Wait half a second after completing input before proceeding
-    delay(500);
-    
+    CO_WAIT_MS(co, 500);
+    FlushGestures();
+
     // Convert string to number
-    int16_t result = 0;
+    *result = 0;
     for (uint8_t i = 0; i < numDigits; i++) {
-        result = result * 10 + (input[i] - '0');
+        *result = *result * 10 + (input[i] - '0');
     }
-    
-    return result;
+    CO_END(co);
 }
 
 // ==================== MENU NAVIGATION ====================
 
-// Wait for button press and return button number (0-4)
-uint8_t WaitForButton() {
-    int16_t aggr[5] = {0, 0, 0, 0, 0};
-    uint8_t lastDetected = 0xFF;
-    const int16_t THRESHOLD = 6;
-    const uint16_t timeout = 10;
+// Wait for button press and return button number (0-4) in *button, or
+// 0xFF if the menu timeout expired first.
+// A pad that is already held when this is called has to be released first.
+uint8_t WaitForButton(Coroutine* co, uint8_t* button) {
+    static uint8_t lastDetected;
+    static uint16_t scan;
 
+    CO_BEGIN(co);
+    lastDetected = activePad;
     while(1) {
-        ReadCTMU();
+        scan = touchScans;
+        CO_YIELD_UNTIL(co, touchScans != scan || uiTimedOut);
+        if (uiTimedOut) {
+            *button = 0xFF;
+            CO_EXIT(co);
+        }
 
-        for (uint8_t i = 0; i < 5; i++) {
-            if (buttons[i]) aggr[i]++;
-            else aggr[i]--;
-            if (aggr[i] < 0) aggr[i] = 0;
-            if (aggr[i] > 30) aggr[i] = 30;
+        if (activePad != 0xFF && activePad != lastDetected) {
+            *button = activePad;
+            CO_WAIT_MS(co, 200); // Debounce
+            FlushGestures();
+            CO_EXIT(co);
+        } else if (activePad == 0xFF) {
+            lastDetected = 0xFF;
         }
+    }
+    CO_END(co);
+}
 
-        int16_t maxVal = THRESHOLD;
-        uint8_t maxButton = 0xFF;
-        for (uint8_t i = 0; i < 5; i++) {
-            if (aggr[i] > maxVal) {
-                maxVal = aggr[i];
-                maxButton = i;
-            }
+// Gestures (tap, double tap, long press, hold-to-repeat) come from the
+// recognizer in the touch task, a coroutine waits for one with
+// CO_YIELD_UNTIL(co, GetGesture(&g)). A held UP/DOWN keeps repeating while
+// the caller redraws.
+
+// ==================== MENU FLOWS ====================
+// Each flow is a coroutine (see Coroutine.h) run by the UI task. Every wait
+// in a flow returns to the scheduler, so the other tasks run meanwhile.
+
+// express: 1 = skip the "... MENU" / "LOADING..." screens
+uint8_t RegisterFlow(Coroutine* co, uint8_t express) {
+    static Coroutine sub;
+    static uint16_t userId;
+    static uint8_t pattern[PATTERN_LENGTH];
+    static uint16_t timing[PATTERN_LENGTH - 1];
+
+    CO_BEGIN(co);
+    // Registration flow
+    if (!express) {
+        DisplayCentered("REGISTER MENU");
+        CO_PAUSE(co, ux->introMs);
+        DisplayCentered("LOADING...");
+        CO_PAUSE(co, ux->introMs * 2);
+    }
+
+    // Check if database is full
+    if (UserCount() >= USER_KEYS) {
+        // Failure: database full -> RED blink
+        RGBBlink(255, 0, 0, ux->blinks, ux->blinkMs, ux->blinkMs);
+        DisplayTwoLines("DATABASE", "FULL!");
+        CO_PAUSE(co, ux->errorMs);
+        DisplayCentered("REDIRECTING...");
+        CO_PAUSE(co, ux->introMs);
+        CO_EXIT(co);  // Back to menu
+    }
+
+    // Prompt for ID
+    DisplayTwoLines("PLEASE ENTER", "ID");
+    CO_PAUSE(co, ux->infoMs);
+
+    // Collect the ID (automatically proceeds)
+    CO_SPAWN(co, &sub, CollectDigits(&sub, USER_ID_DIGITS, "ID", &userId));
+
+    // Check if ID already exists
+    if (FindUser(userId) != USER_NONE) {
+        // Failure: ID already exists -> RED blink
+        RGBBlink(255, 0, 0, ux->blinks, ux->blinkMs, ux->blinkMs);
+        DisplayTwoLines("ID ALREADY", "EXISTS!");
+        CO_PAUSE(co, ux->errorMs);
+        DisplayCentered("REDIRECTING...");
+        CO_PAUSE(co, ux->introMs);
+        CO_EXIT(co);  // Back to menu
+    }
+
+    // Prompt for Pattern
+    DisplayTwoLines("DRAW YOUR", "PATTERN");
+    CO_PAUSE(co, ux->infoMs);
+
+    // Collect 5-button pattern (swipe-based)
+    CO_SPAWN(co, &sub, CollectPattern(&sub, pattern, timing));
+
+    // Register the user
+    if (RegisterUser(userId, pattern, timing)) {  // GREEN blink, commit on the event
+        ShowSuccess("REGISTRATION SUCCESS");
+        CO_PAUSE(co, ux->infoMs);
+    } else {
+        // Failure: registration -> RED blink
+        RGBBlink(255, 0, 0, ux->blinks, ux->blinkMs, ux->blinkMs);
+        ShowError("REGISTRATION FAILED");
+        CO_PAUSE(co, ux->infoMs);
+    }
+    DisplayCentered("REDIRECTING...");
+    CO_PAUSE(co, ux->introMs);
+    CO_END(co);
+}
+
+uint8_t LoginFlow(Coroutine* co, uint8_t express) {
+    static Coroutine sub;
+    static uint16_t userId;
+    static UserKey userKey;
+    static uint8_t pattern[PATTERN_LENGTH];
+    static uint16_t timing[PATTERN_LENGTH - 1];
+    static uint8_t timingWarning;
+    static uint8_t segmentMatches[PATTERN_LENGTH - 1];  // Array to store segment match results
+    static uint8_t failedSegments[PATTERN_LENGTH - 1];
+    static uint8_t segmentsMatched;
+
+    CO_BEGIN(co);
+    // Login flow
+    if (!express) {
+        DisplayCentered("LOGIN MENU");
+        CO_PAUSE(co, ux->introMs);
+        DisplayCentered("LOADING...");
+        CO_PAUSE(co, ux->introMs * 2);
+    }
+
+    // Prompt for ID
+    DisplayTwoLines("PLEASE ENTER", "ID");
+    CO_PAUSE(co, ux->infoMs);
+
+    // Collect the ID (automatically proceeds)
+    CO_SPAWN(co, &sub, CollectDigits(&sub, USER_ID_DIGITS, "ID", &userId));
+
+    // Check if user exists
+    userKey = FindUser(userId);
+    if (userKey == USER_NONE) {
+        CO_SPAWN(co, &sub, ShowLoadingAnimation(&sub, "CHECKING", ux->checkMs));
+        // Failure: invalid user ID -> RED blink
+        RGBBlink(255, 0, 0, ux->blinks, ux->blinkMs, ux->blinkMs);
+        ShowError("INVALID USER ID");
+        CO_PAUSE(co, ux->errorMs);
+        DisplayCentered("REDIRECTING...");
+        CO_PAUSE(co, ux->introMs);
+        CO_EXIT(co);  // Back to menu
+    }
+
+    // Check if account is locked (3 failed attempts, LOCKOUT_S not over)
+    ApplyTimePolicies();
+    if (UserIsLocked(userKey)) {
+        CO_SPAWN(co, &sub, ShowLoadingAnimation(&sub, "CHECKING", ux->checkMs));
+        // Failure: account already locked -> RED blink
+        RGBBlink(255, 0, 0, ux->blinks, ux->blinkMs, ux->blinkMs);
+        ShowError("ACCOUNT LOCKED");
+        CO_PAUSE(co, ux->errorMs);
+        DisplayCentered("REDIRECTING...");
+        CO_PAUSE(co, ux->introMs);
+        CO_EXIT(co);  // Back to menu - don't allow login
+    }
+
+    // Prompt for Pattern
+    DisplayTwoLines("DRAW YOUR", "PATTERN");
+    CO_PAUSE(co, ux->infoMs);
+
+    // Collect 5-button pattern (swipe-based)
+    CO_SPAWN(co, &sub, CollectPattern(&sub, pattern, timing));
+
+    // Validate credentials
+    CO_SPAWN(co, &sub, ShowLoadingAnimation(&sub, "CHECKING", ux->verifyMs));
+    timingWarning = 0;
+    if (ValidateLogin(userId, pattern, timing, &timingWarning, segmentMatches)) {
+        // Login successful - reset failed attempts and mark as logged in
+        if (UserGet(userKey)->failedAttempts > 0) {
+            UserSetAttempts(userKey, 0);
+            EventPublish(EVENT_DB_CHANGED, 0);
         }
+        StartSession(userKey);
 
-        if (maxButton != 0xFF && maxButton != lastDetected) {
-            delay(200); // Debounce
-            return maxButton;
-        } else if (maxButton == 0xFF) {
-            lastDetected = 0xFF;
+        // Always show timing analysis after successful login
+        ShowTimingAnalysis(segmentMatches, PATTERN_LENGTH - 1);
+        CO_PAUSE(co, ux->analysisMs);
+
+        // If timing warning exists, show additional message
+        if (timingWarning) {
+            DisplayTwoLines("TIMING WARNING", "BUT LOGIN OK");
+            CO_PAUSE(co, ux->infoMs);
         }
 
-        delay(timeout);
+        // Success: login -> GREEN blink (event subscriber)
+        EventPublish(EVENT_LOGIN_OK, userId);
+        ShowSuccess("LOGIN SUCCESS");
+        CO_PAUSE(co, ux->infoMs);
+    } else {
+        // Login failed - check if pattern matches first
+        const User* u = UserGet(userKey);
+        uint8_t patternMatches = ComparePatterns(u->pattern, pattern);
+
+        if (patternMatches) {
+            // Pattern matches but timing failed - show timing analysis
+            segmentsMatched = 0;
+
+            for (uint8_t i = 0; i < PATTERN_LENGTH - 1; i++) {
+                uint16_t stored = u->timing[i];
+                uint16_t input = timing[i];
+                if (stored == 0 || input == 0) {
+                    failedSegments[i] = 0;
+                } else {
+                    uint16_t diff = (stored > input) ? (stored - input) : (input - stored);
+                    uint32_t diffPercent = (uint32_t)diff * 100 / stored;
+                    if (diffPercent <= 40) {
+                        failedSegments[i] = 1;
+                        segmentsMatched++;
+                    } else {
+                        failedSegments[i] = 0;
+                    }
+                }
+            }
+
+            // Show timing analysis to explain failure
+            ShowTimingAnalysis(failedSegments, PATTERN_LENGTH - 1);
+            CO_PAUSE(co, ux->errorMs);
+
+            // Show failure reason
+            if (segmentsMatched < 2) {
+                DisplayTwoLines("TIMING FAILED", "NEED 2/4 MATCH");
+            } else {
+                DisplayTwoLines("LOGIN FAILED", "");
+            }
+            CO_PAUSE(co, ux->infoMs);
+        } else {
+            // Pattern doesn't match - don't show timing analysis
+            DisplayTwoLines("PATTERN", "INCORRECT");
+            CO_PAUSE(co, ux->infoMs);
+        }
+
+        // Increment failed attempts; RED blink and commit follow the event
+        // Check if account should be locked now
+        uint8_t attempts = RecordFailedLogin(userKey);
+        if (attempts >= USER_LOCK_ATTEMPTS) {
+            ShowError("ACCOUNT LOCKED");
+            CO_PAUSE(co, ux->errorMs);
+        } else {
+            // Show remaining attempts
+            char msg[30];
+            uint8_t remaining = USER_LOCK_ATTEMPTS - attempts;
+            sprintf(msg, "%u ATTEMPTS LEFT", remaining);
+            DisplayCentered(msg);
+            CO_PAUSE(co, ux->errorMs);
+        }
     }
+    DisplayCentered("REDIRECTING...");
+    CO_PAUSE(co, ux->introMs);
+    CO_END(co);
 }
 
-// ==================== MAIN APPLICATION ====================
+uint8_t DeleteFlow(Coroutine* co, uint8_t express) {
+    static Coroutine sub;
+    static uint16_t userId;
+    static uint8_t pattern[PATTERN_LENGTH];
+    static uint16_t timing[PATTERN_LENGTH - 1];
+    static uint8_t timingWarning;
+    static uint8_t segmentMatches[PATTERN_LENGTH - 1];  // Array to store segment match results
+    static uint8_t confirmBtn;
+
+    CO_BEGIN(co);
+    // Delete user flow
+    if (!express) {
+        DisplayCentered("DELETE MENU");
+        CO_PAUSE(co, ux->introMs);
+        DisplayCentered("LOADING...");
+        CO_PAUSE(co, ux->introMs * 2);
+    }
 
-int main(void) {
-    INIT_CLOCK(); 
-    CTMUInit(); 
-    RGBMapColorPins();
+    // Check if database is empty
+    if (UserCount() == 0) {
+        DisplayTwoLines("FIRST REGISTER", "USERS!");
+        CO_PAUSE(co, ux->errorMs);
+        DisplayCentered("REDIRECTING...");
+        CO_PAUSE(co, ux->introMs);
+        CO_EXIT(co);  // Back to menu
+    }
+
+    // Prompt for ID
+    DisplayTwoLines("PLEASE ENTER", "ID");
+    CO_PAUSE(co, ux->infoMs);
+
+    // Collect the ID (automatically proceeds)
+    CO_SPAWN(co, &sub, CollectDigits(&sub, USER_ID_DIGITS, "ID", &userId));
+
+    // Check if user exists
+    if (FindUser(userId) == USER_NONE) {
+        CO_SPAWN(co, &sub, ShowLoadingAnimation(&sub, "CHECKING", ux->checkMs));
+        // Failure: invalid user ID -> RED blink
+        RGBBlink(255, 0, 0, ux->blinks, ux->blinkMs, ux->blinkMs);
+        ShowError("INVALID USER ID");
+        CO_PAUSE(co, ux->errorMs);
+        DisplayCentered("REDIRECTING...");
+        CO_PAUSE(co, ux->introMs);
+        CO_EXIT(co);  // Back to menu
+    }
+
+    // Prompt for Pattern (authentication required)
+    DisplayTwoLines("AUTHENTICATE", "TO DELETE");
+    CO_PAUSE(co, ux->infoMs);
+
+    // Collect 5-button pattern (swipe-based)
+    CO_SPAWN(co, &sub, CollectPattern(&sub, pattern, timing));
+
+    // Validate credentials
+    CO_SPAWN(co, &sub, ShowLoadingAnimation(&sub, "CHECKING", ux->verifyMs));
+    timingWarning = 0;
+    if (ValidateLogin(userId, pattern, timing, &timingWarning, segmentMatches)) {
+        // Always show timing analysis after successful authentication
+        ShowTimingAnalysis(segmentMatches, PATTERN_LENGTH - 1);
+        CO_PAUSE(co, ux->analysisMs);
+
+        // If timing warning exists, show additional message
+        if (timingWarning) {
+            DisplayTwoLines("TIMING WARNING", "BUT AUTH OK");
+            CO_PAUSE(co, ux->infoMs);
+        }
+
+        // Authentication successful - show confirmation alert
+        DisplayTwoLines("DELETE USER?", "CENTER=YES");
+        CO_PAUSE(co, ux->infoMs);
+
+        // Wait for confirmation (CENTER = confirm, any other = cancel)
+        CO_SPAWN(co, &sub, WaitForButton(&sub, &confirmBtn));
+
+        if (confirmBtn == 4) {  // CENTER = YES, confirm deletion
+            // Delete the user
+            if (DeleteUser(userId)) {  // GREEN blink, commit on the event
+                ShowSuccess("USER DELETED");
+                CO_PAUSE(co, ux->infoMs);
+            } else {
+                // Failure: deletion failed -> RED blink
+                RGBBlink(255, 0, 0, ux->blinks, ux->blinkMs, ux->blinkMs);
+                ShowError("DELETE FAILED");
+                CO_PAUSE(co, ux->infoMs);
+            }
+        } else {
+            // User cancelled - no action
+            DisplayTwoLines("CANCELLED", "");
+            CO_PAUSE(co, ux->infoMs);
+        }
+    } else {
+        // Authentication failed - don't allow deletion
+        // Failure: wrong pattern -> RED blink
+        RGBBlink(255, 0, 0, ux->blinks, ux->blinkMs, ux->blinkMs);
+        ShowError("AUTH FAILED");
+        CO_PAUSE(co, ux->errorMs);
+    }
+    DisplayCentered("REDIRECTING...");
+    CO_PAUSE(co, ux->introMs);
+    CO_END(co);
+}
+
+uint8_t ListFlow(Coroutine* co, uint8_t express) {
+    static Coroutine sub;
+    static uint8_t passwordOk;
+    static uint8_t listSelectedIndex;    // 0 to LIST_ITEMS - 1
+    static uint8_t inListSubMenu;
+    static uint8_t quickExit;
+    static Gesture g;
+
+    CO_BEGIN(co);
+    // LIST submenu navigation - requires admin password
+    if (!express) {
+        DisplayCentered("LIST MENU");
+        CO_PAUSE(co, ux->introMs);
+    }
     
-    RGBTurnOnLED();
-    ResetDevice();
+    // Request admin password
+    CO_SPAWN(co, &sub, VerifyAdminPassword(&sub, &passwordOk));
+    if (!passwordOk) {
+        // Password incorrect - show error and return to main menu
+        CO_SPAWN(co, &sub, ShowLoadingAnimation(&sub, "CHECKING", ux->checkMs));
+        EventPublish(EVENT_ADMIN_DENIED, 0);  // RED blink, audit
+        ShowError("ACCESS DENIED");
+        CO_PAUSE(co, ux->errorMs);
+        DisplayCentered("REDIRECTING...");
+        CO_PAUSE(co, ux->introMs);
+        CO_EXIT(co);  // Back to main menu
+    }
     
-    // Load user database from Flash (first boot initializes empty database)
-    FlashReadDatabase();
+    // Password correct - show success and proceed
+    CO_SPAWN(co, &sub, ShowLoadingAnimation(&sub, "CHECKING", ux->checkMs));
+    RGBBlink(0, 255, 0, ux->blinks, ux->blinkMs, ux->blinkMs);
+    ShowSuccess("ACCESS GRANTED");
+    CO_PAUSE(co, ux->infoMs * 3 / 4);
     
-    // Startup greeting
-    ShowMessage("HELLO!", 3);
+    // LIST submenu, three items per screen with a navigable highlight (always
+    // accessible, even with no users):
+    // REGISTERED, ACTIVE USERS, LOCKED | DELETED, DEL USER, TIMING |
+    // PROFILER, AUDIT, CLOCK | BACK
+    // Button mapping (index from WaitForButton):
+    //   0 = UP (previous item), 2 = DOWN (next item), both wrap around,
+    //   4 = CENTER (select), 3 = LEFT (back to main menu)
+    // Holding UP/DOWN scrolls, a double tap on UP/DOWN jumps to the
+    // first/last item, a long press on LEFT leaves without the
+    // "REDIRECTING..." screen.
+    listSelectedIndex = 0;
+    inListSubMenu = 1;
+    quickExit = 0;
     
-    // Main application loop
-    while(1) { 
-        // Main menu with two screens, side-by-side options:
-        // Screen 0: REGISTER (left) | LOGIN (right)
-        // Screen 1: DELETE (left) | LIST (right)
-        // Button mapping (index from WaitForButton):
-        //   0 = UP (go to screen 0), 2 = DOWN (go to screen 1), 
-        //   3 = LEFT (select left option), 1 = RIGHT (select right option), 4 = CENTER (confirm selection)
-        uint8_t screenIndex = 0;      // 0 = Screen 1 (REGISTER|LOGIN), 1 = Screen 2 (DELETE|LIST)
-        uint8_t selectedIndex = 0;    // 0 = Left option, 1 = Right option
-        uint8_t inMenu = 1;
+    while (inListSubMenu) {
+        DrawListSubMenu(listSelectedIndex);
+        CO_YIELD_UNTIL(co, GetGesture(&g) || uiTimedOut);
+        if (uiTimedOut) CO_EXIT(co);  // admin walked away
+        uint8_t btn = g.pad;
+        
+        if (g.type == GESTURE_DOUBLE_TAP && btn == 0) {  // to first
+            listSelectedIndex = 0;
+        } else if (g.type == GESTURE_DOUBLE_TAP && btn == 2) {  // to BACK
+            listSelectedIndex = LIST_BACK;
+        } else if (btn == 0) {          // UP
+            listSelectedIndex = (listSelectedIndex > 0) ?
+                listSelectedIndex - 1 : LIST_ITEMS - 1;
+        } else if (btn == 2) {   // DOWN
+            listSelectedIndex = (listSelectedIndex < LIST_ITEMS - 1) ?
+                listSelectedIndex + 1 : 0;
+        } else if (btn == 4) {   // CENTER = select
+            if (listSelectedIndex == LIST_BACK) {
+                inListSubMenu = 0;
+            } else if (listSelectedIndex == LIST_DEL_USER) {
+                // Admin delete by ID
+                CO_SPAWN(co, &sub, AdminDeleteById(&sub));
+            } else if (listSelectedIndex == LIST_TIMING) {
+                CO_SPAWN(co, &sub, SelectTimingProfile(&sub));
+            } else if (listSelectedIndex == LIST_PROFILER) {
+                CO_SPAWN(co, &sub, ShowProfiler(&sub));
+            } else if (listSelectedIndex == LIST_AUDIT) {
+                CO_SPAWN(co, &sub, ShowAuditLog(&sub));
+            } else if (listSelectedIndex == LIST_CLOCK) {
+                CO_SPAWN(co, &sub, SetWallClock(&sub));
+            } else if (listSelectedIndex == LIST_STORE) {
+                CO_SPAWN(co, &sub, ShowUserStore(&sub));
+            } else {
+                // Display the list - after button press, return to LIST submenu
+                CO_SPAWN(co, &sub, DisplayUserList(&sub, listSelectedIndex));
+            }
+        } else if (btn == 3) {   // LEFT = back to main menu
+            inListSubMenu = 0;
+            quickExit = (g.type == GESTURE_LONG_PRESS);
+        }
+        // Other buttons (1=RIGHT) are ignored in menu
+    }
+    
+    // Only show redirecting message if we're actually leaving LIST menu
+    if (!inListSubMenu && !quickExit) {
+        DisplayCentered("REDIRECTING...");
+        CO_PAUSE(co, ux->introMs);
+    }
+    CO_END(co);
+}
+
+// ==================== UI TASK ====================
+
+// Main menu with two screens, side-by-side options:
+// Screen 0: REGISTER (left) | LOGIN (right)
+// Screen 1: DELETE (left) | LIST (right)
+// Button mapping (pad index of the gesture):
+//   0 = UP (go to screen 0), 2 = DOWN (go to screen 1), 
+//   3 = LEFT (select left option), 1 = RIGHT (select right option), 4 = CENTER (confirm selection)
+// Shortcuts: double tap on LEFT/RIGHT opens that option, a long press
+// on LEFT/RIGHT/CENTER opens it and skips the intro screens, a long press
+// on DOWN shows the task statistics.
+// Screens for the CPU time / current report (Power.c)
+#define SCREEN_MENU     0
+#define SCREEN_REGISTER 1
+#define SCREEN_LOGIN    2
+#define SCREEN_DELETE   3
+#define SCREEN_LIST     4
+#define SCREEN_STATS    5
+
+PowerScreen screenTable[] = {
+    {"MENU"}, {"REGIST"}, {"LOGIN"}, {"DELETE"}, {"LIST"}, {"STATS"},
+};
+
+uint8_t MainMenu(Coroutine* co) {
+    static Coroutine sub;
+    static uint8_t screenIndex;      // 0 = Screen 1 (REGISTER|LOGIN), 1 = Screen 2 (DELETE|LIST)
+    static uint8_t selectedIndex;    // 0 = Left option, 1 = Right option
+    static uint8_t inMenu;
+    static uint8_t express;          // 1 = skip "... MENU" / "LOADING..."
+    static uint32_t flowStart;
+    static Gesture g;
+
+    CO_BEGIN(co);
+    // Startup greeting
+    DisplayCentered("HELLO!");
+    CO_PAUSE(co, ux->greetMs);
+    FlushGestures();
+
+    while (1) {
+        screenIndex = 0;
+        selectedIndex = 0;
+        inMenu = 1;
+        express = 0;
 
         while (inMenu) {
             DrawMainMenu(screenIndex, selectedIndex);
-            uint8_t btn = WaitForButton();
+            do {
+                CO_YIELD_UNTIL(co, GetGesture(&g) || uiTimedOut);
+            } while (!uiTimedOut && g.type == GESTURE_REPEAT);  // nothing to scroll here
+            uint8_t btn = g.pad;
 
-            if (btn == 0) {          // UP (button 1) - go to screen 0
+            if (uiTimedOut) {         // idle: back to the first screen
+                uiTimedOut = 0;
+                screenIndex = 0;
+                selectedIndex = 0;
+            } else if (g.type == GESTURE_LONG_PRESS && btn == 2) {
+                PowerSetScreen(SCREEN_STATS);
+                CO_SPAWN(co, &sub, ShowTaskStats(&sub));
+                PowerSetScreen(SCREEN_MENU);
+            } else if ((g.type == GESTURE_LONG_PRESS || g.type == GESTURE_DOUBLE_TAP) &&
+                    (btn == 1 || btn == 3 || btn == 4)) {
+                if (btn == 3) selectedIndex = 0;
+                if (btn == 1) selectedIndex = 1;
+                express = (g.type == GESTURE_LONG_PRESS);
+                inMenu = 0;
+            } else if (btn == 0) {          // UP (button 1) - go to screen 0
                 screenIndex = 0;
                 selectedIndex = 0;   // Reset to left option
-                // Redraw immediately to show screen change
-                DrawMainMenu(screenIndex, selectedIndex);
-                delay(100);  // Small delay to ensure screen update is visible
             } else if (btn == 2) {   // DOWN (button 3) - go to screen 1
                 screenIndex = 1;
                 selectedIndex = 0;   // Reset to left option
-                // Redraw immediately to show screen change
-                DrawMainMenu(screenIndex, selectedIndex);
-                delay(100);  // Small delay to ensure screen update is visible
             } else if (btn == 3) {   // LEFT (button 4) - select left option
                 selectedIndex = 0;
             } else if (btn == 1) {   // RIGHT (button 2) - select right option
@@ -1344,406 +2714,185 @@ int main(void) {
         }
 
         // Determine which option was selected based on screen and position
-        uint8_t finalSelection;
-        if (screenIndex == 0) {
-            // Screen 0: REGISTER (0) or LOGIN (1)
-            finalSelection = selectedIndex;
+        PowerSetScreen(SCREEN_REGISTER + screenIndex * 2 + selectedIndex);
+        if (ux->introMs == 0) express = 1;
+        flowStart = millis();
+        if (screenIndex == 0 && selectedIndex == 0) {
+            CO_SPAWN(co, &sub, RegisterFlow(&sub, express));
+        } else if (screenIndex == 0) {
+            CO_SPAWN(co, &sub, LoginFlow(&sub, express));
+        } else if (selectedIndex == 0) {
+            CO_SPAWN(co, &sub, DeleteFlow(&sub, express));
         } else {
-            // Screen 1: DELETE (2) or LIST (3)
-            finalSelection = selectedIndex + 2;
+            CO_SPAWN(co, &sub, ListFlow(&sub, express));
+        }
+        if (!(screenIndex == 1 && selectedIndex == 1)) {  // LIST is admin work
+            RecordTransaction(millis() - flowStart);
         }
 
-        if (finalSelection == 0) {  // REGISTER selected
-            // Registration flow
-            ShowMessage("REGISTER MENU", 1);
-            ShowMessage("LOADING...", 2);
-            
-            // Check if database is full
-            if (userCount >= MAX_USERS) {
-                // Failure: database full -> RED blink
-                BlinkRGB(255, 0, 0, 3, 200, 200);
-                DisplayTwoLines("DATABASE", "FULL!");
-                delay(3000);
-                ShowMessage("REDIRECTING...", 1);
-                continue;  // Back to menu
-            }
-            
-            // Prompt for ID
-            DisplayTwoLines("PLEASE ENTER", "ID");
-            delay(2000);
-            
-            // Collect 2-digit ID (automatically proceeds)
-            int16_t userId = CollectDigits(2, "ID");
-            
-            // Check if ID already exists
-            if (FindUser(userId) != -1) {
-                // Failure: ID already exists -> RED blink
-                BlinkRGB(255, 0, 0, 3, 200, 200);
-                DisplayTwoLines("ID ALREADY", "EXISTS!");
-                delay(3000);
-                ShowMessage("REDIRECTING...", 1);
-                continue;  // Back to menu
-            }
-            
-            // Prompt for Pattern
-            DisplayTwoLines("DRAW YOUR", "PATTERN");
-            delay(2000);
-            
-            // Collect 5-button pattern (swipe-based)
-            uint8_t pattern[PATTERN_LENGTH];
-            uint16_t timing[PATTERN_LENGTH - 1];
-            CollectPattern(pattern, timing);
-            
-            // Register the user
-            if (RegisterUser(userId, pattern, timing)) {
-                FlashWriteDatabase();
-                // Success: registration -> GREEN blink
-                BlinkRGB(0, 255, 0, 3, 200, 200);
-                ShowSuccess("REGISTRATION SUCCESS");
-                delay(2000);
-            } else {
-                // Failure: registration -> RED blink
-                BlinkRGB(255, 0, 0, 3, 200, 200);
-                ShowError("REGISTRATION FAILED");
-                delay(2000);
-            }
-            ShowMessage("REDIRECTING...", 1);
-            
-        } else if (finalSelection == 1) {  // LOGIN selected
-            // Login flow
-            ShowMessage("LOGIN MENU", 1);
-            ShowMessage("LOADING...", 2);
-            
-            // Prompt for ID
-            DisplayTwoLines("PLEASE ENTER", "ID");
-            delay(2000);
-            
-            // Collect 2-digit ID (automatically proceeds)
-            int16_t userId = CollectDigits(2, "ID");
-            
-            // Check if user exists
-            int8_t userIndex = FindUser(userId);
-            if (userIndex == -1) {
-                ShowLoadingAnimation("CHECKING", 1000);
-                // Failure: invalid user ID -> RED blink
-                BlinkRGB(255, 0, 0, 3, 200, 200);
-                ShowError("INVALID USER ID");
-                delay(3000);
-                ShowMessage("REDIRECTING...", 1);
-                continue;  // Back to menu
-            }
-            
-            // Check if account is locked (3 failed attempts)
-            if (userDatabase[userIndex].failedAttempts >= 3) {
-                ShowLoadingAnimation("CHECKING", 1000);
-                // Failure: account already locked -> RED blink
-                BlinkRGB(255, 0, 0, 3, 200, 200);
-                ShowError("ACCOUNT LOCKED");
-                delay(3000);
-                ShowMessage("REDIRECTING...", 1);
-                continue;  // Back to menu - don't allow login
-            }
-            
-            // Prompt for Pattern
-            DisplayTwoLines("DRAW YOUR", "PATTERN");
-            delay(2000);
-            
-            // Collect 5-button pattern (swipe-based)
-            uint8_t pattern[PATTERN_LENGTH];
-            uint16_t timing[PATTERN_LENGTH - 1];
-            CollectPattern(pattern, timing);
-            
-            // Validate credentials
-            ShowLoadingAnimation("CHECKING", 2000);
-            uint8_t timingWarning = 0;
-            uint8_t segmentMatches[PATTERN_LENGTH - 1];  // Array to store segment match results
-            if (ValidateLogin(userId, pattern, timing, &timingWarning, segmentMatches)) {
-                // Login successful - reset failed attempts and mark as logged in
-                if (userDatabase[userIndex].failedAttempts > 0) {
-                    userDatabase[userIndex].failedAttempts = 0;
-                    FlashWriteDatabase();
-                }
-                userDatabase[userIndex].isLoggedIn = 1;
-                
-                // Always show timing analysis after successful login
-                ShowTimingAnalysis(segmentMatches, PATTERN_LENGTH - 1);
-                delay(5000);
-                
-                // If timing warning exists, show additional message
-                if (timingWarning) {
-                    DisplayTwoLines("TIMING WARNING", "BUT LOGIN OK");
-                    delay(2000);
-                }
-                
-                // Success: login -> GREEN blink
-                BlinkRGB(0, 255, 0, 3, 200, 200);
-                ShowSuccess("LOGIN SUCCESS");
-                delay(2000);
-            } else {
-                // Login failed - check if pattern matches first
-                uint8_t patternMatches = ComparePatterns(userDatabase[userIndex].pattern, pattern);
-                
-                if (patternMatches) {
-                    // Pattern matches but timing failed - show timing analysis
-                    uint8_t failedSegments[PATTERN_LENGTH - 1];
-                    uint8_t segmentsMatched = 0;
-                    
-                    for (uint8_t i = 0; i < PATTERN_LENGTH - 1; i++) {
-                        uint16_t stored = userDatabase[userIndex].timing[i];
-                        uint16_t input = timing[i];
-                        if (stored == 0 || input == 0) {
-                            failedSegments[i] = 0;
-                        } else {
-                            uint16_t diff = (stored > input) ? (stored - input) : (input - stored);
-                            uint32_t diffPercent = (uint32_t)diff * 100 / stored;
-                            if (diffPercent <= 40) {
-                                failedSegments[i] = 1;
-                                segmentsMatched++;
-                            } else {
-                                failedSegments[i] = 0;
-                            }
-                        }
-                    }
-                    
-                    // Show timing analysis to explain failure
-                    ShowTimingAnalysis(failedSegments, PATTERN_LENGTH - 1);
-                    delay(3000);
-                    
-                    // Show failure reason
-                    if (segmentsMatched < 2) {
-                        DisplayTwoLines("TIMING FAILED", "NEED 2/4 MATCH");
-                    } else {
-                        DisplayTwoLines("LOGIN FAILED", "");
-                    }
-                    delay(2000);
-                } else {
-                    // Pattern doesn't match - don't show timing analysis
-                    DisplayTwoLines("PATTERN", "INCORRECT");
-                    delay(2000);
-                }
-                
-                // Increment failed attempts
-                userDatabase[userIndex].failedAttempts++;
-                FlashWriteDatabase();
-
-                // Check if account should be locked now
-                if (userDatabase[userIndex].failedAttempts >= 3) {
-                    // Failure: account just locked -> RED blink
-                    BlinkRGB(255, 0, 0, 3, 200, 200);
-                    ShowError("ACCOUNT LOCKED");
-                    delay(3000);
-                } else {
-                    // Show remaining attempts
-                    // Failure: wrong pattern/timing but attempts left -> RED blink
-                    BlinkRGB(255, 0, 0, 3, 200, 200);
-                    char msg[30];
-                    uint8_t remaining = 3 - userDatabase[userIndex].failedAttempts;
-                    sprintf(msg, "%u ATTEMPTS LEFT", remaining);
-                    DisplayCentered(msg);
-                    delay(3000);
-                }
-            }
-            ShowMessage("REDIRECTING...", 1);
-            
-        } else if (finalSelection == 2) {  // DELETE selected
-            // Delete user flow
-            ShowMessage("DELETE MENU", 1);
-            ShowMessage("LOADING...", 2);
-            
-            // Check if database is empty
-            if (userCount == 0) {
-                DisplayTwoLines("FIRST REGISTER", "USERS!");
-                delay(3000);
-                ShowMessage("REDIRECTING...", 1);
-                continue;  // Back to menu
-            }
-            
-            // Prompt for ID
-            DisplayTwoLines("PLEASE ENTER", "ID");
-            delay(2000);
-            
-            // Collect 2-digit ID (automatically proceeds)
-            int16_t userId = CollectDigits(2, "ID");
-            
-            // Check if user exists
-            int8_t userIndex = FindUser(userId);
-            if (userIndex == -1) {
-                ShowLoadingAnimation("CHECKING", 1000);
-                // Failure: invalid user ID -> RED blink
-                BlinkRGB(255, 0, 0, 3, 200, 200);
-                ShowError("INVALID USER ID");
-                delay(3000);
-                ShowMessage("REDIRECTING...", 1);
-                continue;  // Back to menu
-            }
-            
-            // Prompt for Pattern (authentication required)
-            DisplayTwoLines("AUTHENTICATE", "TO DELETE");
-            delay(2000);
-            
-            // Collect 5-button pattern (swipe-based)
-            uint8_t pattern[PATTERN_LENGTH];
-            uint16_t timing[PATTERN_LENGTH - 1];
-            CollectPattern(pattern, timing);
-            
-            // Validate credentials
-            ShowLoadingAnimation("CHECKING", 2000);
-            uint8_t timingWarning = 0;
-            uint8_t segmentMatches[PATTERN_LENGTH - 1];  // Array to store segment match results
-            if (ValidateLogin(userId, pattern, timing, &timingWarning, segmentMatches)) {
-                // Always show timing analysis after successful authentication
-                ShowTimingAnalysis(segmentMatches, PATTERN_LENGTH - 1);
-                delay(5000);
-                
-                // If timing warning exists, show additional message
-                if (timingWarning) {
-                    DisplayTwoLines("TIMING WARNING", "BUT AUTH OK");
-                    delay(2000);
-                }
-                
-                // Authentication successful - show confirmation alert
-                DisplayTwoLines("DELETE USER?", "CENTER=YES");
-                delay(2000);
-                
-                // Wait for confirmation (CENTER = confirm, any other = cancel)
-                uint8_t confirmBtn = WaitForButton();
-                
-                if (confirmBtn == 4) {  // CENTER = YES, confirm deletion
-                    // Delete the user
-                    if (DeleteUser(userId)) {
-                        FlashWriteDatabase();
-                        // Success: deletion -> GREEN blink
-                        BlinkRGB(0, 255, 0, 3, 200, 200);
-                        ShowSuccess("USER DELETED");
-                        delay(2000);
-                    } else {
-                        // Failure: deletion failed -> RED blink
-                        BlinkRGB(255, 0, 0, 3, 200, 200);
-                        ShowError("DELETE FAILED");
-                        delay(2000);
-                    }
-                } else {
-                    // User cancelled - no action
-                    DisplayTwoLines("CANCELLED", "");
-                    delay(2000);
-                }
-            } else {
-                // Authentication failed - don't allow deletion
-                // Failure: wrong pattern -> RED blink
-                BlinkRGB(255, 0, 0, 3, 200, 200);
-                ShowError("AUTH FAILED");
-                delay(3000);
-            }
-            ShowMessage("REDIRECTING...", 1);
-            
-        } else if (finalSelection == 3) {  // LIST selected
-            // LIST submenu navigation - requires admin password
-            ShowMessage("LIST MENU", 1);
-            
-            // Request admin password
-            if (!VerifyAdminPassword()) {
-                // Password incorrect - show error and return to main menu
-                ShowLoadingAnimation("CHECKING", 1000);
-                BlinkRGB(255, 0, 0, 3, 200, 200);
-                ShowError("ACCESS DENIED");
-                delay(3000);
-                ShowMessage("REDIRECTING...", 1);
-                continue;  // Back to main menu
-            }
-            
-            // Password correct - show success and proceed
-            ShowLoadingAnimation("CHECKING", 1000);
-            BlinkRGB(0, 255, 0, 2, 200, 200);
-            ShowSuccess("ACCESS GRANTED");
-            delay(1500);
-            
-            // LIST submenu with two screens and navigable highlight box (always accessible, even with no users):
-            // Screen 0: REGISTERED, ACTIVE USERS, LOCKED
-            // Screen 1: DELETED, DEL USER, BACK
-            // Button mapping (index from WaitForButton):
-            //   0 = UP (navigate up/switch screen), 2 = DOWN (navigate down/switch screen), 
-            //   4 = CENTER (select), 3 = LEFT (back to main menu)
-            uint8_t listScreenIndex = 0;      // 0 = Screen 1, 1 = Screen 2
-            uint8_t listSelectedIndex = 0;    // 0-2 for Screen 1, 0-2 for Screen 2
-            uint8_t inListSubMenu = 1;
-            
-            while (inListSubMenu) {
-                DrawListSubMenu(listScreenIndex, listSelectedIndex);
-                uint8_t btn = WaitForButton();
-                
-                if (btn == 0) {          // UP
-                    if (listScreenIndex == 0) {
-                        // On Screen 1, navigate up within screen
-                        if (listSelectedIndex > 0) {
-                            listSelectedIndex--;
-                        } else {
-                            // At top of Screen 1, wrap to Screen 2
-                            listScreenIndex = 1;
-                            listSelectedIndex = 2;  // Go to BACK option
-                        }
-                    } else {
-                        // On Screen 2, navigate up within screen
-                        if (listSelectedIndex > 0) {
-                            listSelectedIndex--;
-                        } else {
-                            // At top of Screen 2, go to Screen 1
-                            listScreenIndex = 0;
-                            listSelectedIndex = 2;  // Go to LOCKED option
-                        }
-                    }
-                } else if (btn == 2) {   // DOWN
-                    if (listScreenIndex == 0) {
-                        // On Screen 1, navigate down within screen
-                        if (listSelectedIndex < 2) {
-                            listSelectedIndex++;
-                        } else {
-                            // At bottom of Screen 1, go to Screen 2
-                            listScreenIndex = 1;
-                            listSelectedIndex = 0;  // Go to DELETED option
-                        }
-                    } else {
-                        // On Screen 2, navigate down within screen
-                        if (listSelectedIndex < 2) {
-                            listSelectedIndex++;
-                        } else {
-                            // At bottom of Screen 2, wrap to Screen 1
-                            listScreenIndex = 0;
-                            listSelectedIndex = 0;  // Go to REGISTERED option
-                        }
-                    }
-                } else if (btn == 4) {   // CENTER = select
-                    // Convert screen + selected index to actual option index
-                    uint8_t actualIndex;
-                    if (listScreenIndex == 0) {
-                        actualIndex = listSelectedIndex;  // 0=REGISTERED, 1=ACTIVE USERS, 2=LOCKED
-                    } else {
-                        actualIndex = listSelectedIndex + 3;  // 3=DELETED, 4=DEL USER, 5=BACK
-                    }
-                    
-                    // If BACK is selected, go back to main menu
-                    if (actualIndex == 5) {
-                        inListSubMenu = 0;
-                    } else if (actualIndex == 4) {
-                        // Admin delete by ID
-                        AdminDeleteById();
-                    } else {
-                        // Display the list - after button press, return to LIST submenu
-                        DisplayUserList(actualIndex);
-                        // After displaying list, continue in LIST submenu loop (don't exit)
-                        // The loop will continue and show the LIST submenu again
-                    }
-                } else if (btn == 3) {   // LEFT = back to main menu
-                    inListSubMenu = 0;
-                }
-                // Other buttons (1=RIGHT) are ignored in menu
-            }
-            
-            // Only show redirecting message if we're actually leaving LIST menu
-            if (!inListSubMenu) {
-                ShowMessage("REDIRECTING...", 1);
-            }
+        // Ignore touches left over from the flow
+        FlushGestures();
+        PowerSetScreen(SCREEN_MENU);
+    }
+    CO_END(co);
+}
+
+Coroutine mainMenu;
+
+// The UI is the main menu coroutine, continued once per task period
+void UiTask(void) {
+    MainMenu(&mainMenu);
+}
+
+// Show run time per task (average/maximum in us, budget overruns), how
+// often the scheduler found nothing to do and the time saved by skipped
+// pauses, until a pad is pressed. Then
+// show CPU load and estimated current per screen, until a pad is pressed.
+// Then show the boot phases (start and duration in ms) and the time to
+// the first usable touch. Then show the supervisor log: resets since
+// power-on, the last watchdog or wait-overrun reset with its task and
+// site, the overruns per wait site and the events lost on a full queue.
+uint8_t ShowTaskStats(Coroutine* co) {
+    static Coroutine sub;
+    static uint8_t btn;
+
+    CO_BEGIN(co);
+    SetColor(BLACK);
+    ClearDevice();
+    SetColor(WHITE);
+    DrawString(0, 0, "TASK   AVG  MAX OVR");
+
+    char line[24];
+    for (uint8_t i = 0; i < SchedulerTaskCount() && i < 5; i++) {
+        Task* t = SchedulerTask(i);
+        uint32_t avg = (t->runs > 0) ? t->totalUs / t->runs : 0;
+        sprintf(line, "%-6s%4lu%5u%4u", t->name, avg, t->maxUs, t->overruns);
+        DrawString(0, 10 + i * 9, line);
+    }
+
+    uint32_t idle = (schedStats.passes > 0) ?
+        schedStats.idlePasses * 100 / schedStats.passes : 0;
+    sprintf(line, "IDLE %lu%% SKIP %luS", idle, pauseSkippedMs / 1000);
+    DrawString(0, 56, line);
+
+    CO_SPAWN(co, &sub, WaitForButton(&sub, &btn));
+    if (btn == 0xFF) CO_EXIT(co);
+
+    SetColor(BLACK);
+    ClearDevice();
+    SetColor(WHITE);
+    DrawString(0, 0, "SCREEN  CPU   MA");
+    for (uint8_t i = 0; i < PowerScreenCount() && i < 6; i++) {
+        uint32_t ua = PowerCurrentUa(i);
+        sprintf(line, "%-7s%3u%%%3lu.%lu", PowerGetScreen(i)->name,
+                PowerCpuPercent(i), ua / 1000, (ua % 1000) / 100);
+        DrawString(0, 9 + i * 9, line);
+    }
+
+    CO_SPAWN(co, &sub, WaitForButton(&sub, &btn));
+    if (btn == 0xFF) CO_EXIT(co);
+
+    SetColor(BLACK);
+    ClearDevice();
+    SetColor(WHITE);
+    sprintf(line, "BOOT  USABLE %lu MS", bootUsableUs / 1000);
+    DrawString(0, 0, line);
+    for (uint8_t i = 0; i < BOOT_PHASES; i++) {
+        BootPhase* p = &bootPhases[i];
+        sprintf(line, "%-6s%5lu.%lu%5lu.%lu", p->name,
+                p->startUs / 1000, (p->startUs % 1000) / 100,
+                p->us / 1000, (p->us % 1000) / 100);
+        DrawString(0, 9 + i * 8, line);
+    }
+
+    CO_SPAWN(co, &sub, WaitForButton(&sub, &btn));
+    if (btn == 0xFF) CO_EXIT(co);
+
+    SetColor(BLACK);
+    ClearDevice();
+    SetColor(WHITE);
+    SupervisorLog* log = &supervisorLog;
+    DrawString(0, 0, "SUPERVISOR");
+    sprintf(line, "RESETS %u", log->resets);
+    DrawString(0, 10, line);
+    sprintf(line, "WDT %u  WAIT %u", log->watchdogResets, log->waitResets);
+    DrawString(0, 19, line);
+    if (log->lastCause == SUPERVISOR_CAUSE_NONE) {
+        DrawString(0, 28, "LAST NONE");
+    } else {
+        sprintf(line, "LAST %s %s %s",
+                (log->lastCause == SUPERVISOR_CAUSE_WATCHDOG) ? "WDT" : "WAIT",
+                (log->lastTask < SchedulerTaskCount()) ?
+                    SchedulerTask(log->lastTask)->name : "BOOT",
+                supervisorSiteNames[log->lastSite]);
+        DrawString(0, 28, line);
     }
+    for (uint8_t i = 1; i < SUPERVISOR_SITES; i++) {
+        sprintf(line, "%-4s%5u", supervisorSiteNames[i], log->siteOverruns[i]);
+        DrawString(0, 28 + i * 9, line);
     }
+    DrawString(66, 37, "EVENTS");
+    sprintf(line, "LOST %u", EventDropped());
+    DrawString(66, 46, line);
+
+    CO_SPAWN(co, &sub, WaitForButton(&sub, &btn));
+    CO_END(co);
+}
+
+// ==================== MAIN APPLICATION ====================
+
+// Task table, in the order a scheduler pass runs them:
+// name, function, period (ms), time budget (us)
+// LED effects, deferred flash writes, timeouts and dimming run as software
+// timer callbacks in the TIMER task.
+Task taskTable[] = {
+    {"TIMER", TimerTask,    1, 60000},   // includes flash page erase + write
+    {"TOUCH", TouchTask,   10,  2000},
+    {"UI",    UiTask,      10,  5000},
+    {"EVENT", EventTask,    1,  2000},   // LED, audit and commit subscribers
+    {"DISP",  DisplayTask,  20,  3000},
+};
+
+int main(void) {
+    SupervisorInit();  // reads the reset cause, starts the watchdog
+    ClockInit();
+    TickInit();
+    ProfileInit();
+    IrqMaskReset();
+    RtccInit(SupervisorColdStart());
+    TimerInit();
+    BootEnd(BOOT_CORE);
+
+    // The panel powers up while the rest initializes, a timer finishes it
+    BootBegin(BOOT_PANEL_ON);
+    DisplayPowerUp();
+    BootEnd(BOOT_PANEL_ON);
+    BootBegin(BOOT_PANEL);
+    TimerStart(&panelTimer, DISPLAY_POWERUP_MS, 0, PanelPoweredUp);
+
+    // Touch warm-up continues in the touch task
+    BootBegin(BOOT_CTMU);
+    CTMUInit(); 
+    BootEnd(BOOT_CTMU);
+    BootBegin(BOOT_WARMUP);
+
+    BootBegin(BOOT_LEDS);
+    RGBMapColorPins();
+    RGBTurnOnLED();
+    BootEnd(BOOT_LEDS);
+    
+    // Load user database from Flash (first boot initializes empty database)
+    BootBegin(BOOT_FLASH);
+    FlashReadDatabase();
+    BootEnd(BOOT_FLASH);
+    
+    EventSetup();
+    UserActivity();  // start the inactivity timers
+    PowerInit(screenTable, sizeof(screenTable) / sizeof(screenTable[0]));
+
+    // Main application loop, the greeting and the menu run in UiTask
+    SchedulerInit(taskTable, sizeof(taskTable) / sizeof(taskTable[0]));
+    SchedulerRun();
     
     RGBTurnOffLED();
 }
@@ -51,17 +51,17 @@ OBJECTDIR=build/${CND_CONF}/${IMAGE_TYPE}
 DISTDIR=dist/${CND_CONF}/${IMAGE_TYPE}
 
 # Source Files Quoted if spaced
-SOURCEFILES_QUOTED_IF_SPACED=SH1101A.c main.c TouchSense.c RGBLeds.c
+SOURCEFILES_QUOTED_IF_SPACED=SH1101A.c main.c TouchSense.c RGBLeds.c SysTick.c Scheduler.c SoftTimer.c Power.c Profile.c Clock.c Event.c Supervisor.c IrqMask.c Rtcc.c Flash.c UserStore.c Journal.c
 
 # Object Files Quoted if spaced
-OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/SH1101A.o ${OBJECTDIR}/main.o ${OBJECTDIR}/TouchSense.o ${OBJECTDIR}/RGBLeds.o
-POSSIBLE_DEPFILES=${OBJECTDIR}/SH1101A.o.d ${OBJECTDIR}/main.o.d ${OBJECTDIR}/TouchSense.o.d ${OBJECTDIR}/RGBLeds.o.d
+OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/SH1101A.o ${OBJECTDIR}/main.o ${OBJECTDIR}/TouchSense.o ${OBJECTDIR}/RGBLeds.o ${OBJECTDIR}/SysTick.o ${OBJECTDIR}/Scheduler.o ${OBJECTDIR}/SoftTimer.o ${OBJECTDIR}/Power.o ${OBJECTDIR}/Profile.o ${OBJECTDIR}/Clock.o ${OBJECTDIR}/Event.o ${OBJECTDIR}/Supervisor.o ${OBJECTDIR}/IrqMask.o ${OBJECTDIR}/Rtcc.o ${OBJECTDIR}/Flash.o ${OBJECTDIR}/UserStore.o ${OBJECTDIR}/Journal.o
+POSSIBLE_DEPFILES=${OBJECTDIR}/SH1101A.o.d ${OBJECTDIR}/main.o.d ${OBJECTDIR}/TouchSense.o.d ${OBJECTDIR}/RGBLeds.o.d ${OBJECTDIR}/SysTick.o.d ${OBJECTDIR}/Scheduler.o.d ${OBJECTDIR}/SoftTimer.o.d ${OBJECTDIR}/Power.o.d ${OBJECTDIR}/Profile.o.d ${OBJECTDIR}/Clock.o.d ${OBJECTDIR}/Event.o.d ${OBJECTDIR}/Supervisor.o.d ${OBJECTDIR}/IrqMask.o.d ${OBJECTDIR}/Rtcc.o.d ${OBJECTDIR}/Flash.o.d ${OBJECTDIR}/UserStore.o.d ${OBJECTDIR}/Journal.o.d
 
 # Object Files
-OBJECTFILES=${OBJECTDIR}/SH1101A.o ${OBJECTDIR}/main.o ${OBJECTDIR}/TouchSense.o ${OBJECTDIR}/RGBLeds.o
+OBJECTFILES=${OBJECTDIR}/SH1101A.o ${OBJECTDIR}/main.o ${OBJECTDIR}/TouchSense.o ${OBJECTDIR}/RGBLeds.o ${OBJECTDIR}/SysTick.o ${OBJECTDIR}/Scheduler.o ${OBJECTDIR}/SoftTimer.o ${OBJECTDIR}/Power.o ${OBJECTDIR}/Profile.o ${OBJECTDIR}/Clock.o ${OBJECTDIR}/Event.o ${OBJECTDIR}/Supervisor.o ${OBJECTDIR}/IrqMask.o ${OBJECTDIR}/Rtcc.o ${OBJECTDIR}/Flash.o ${OBJECTDIR}/UserStore.o ${OBJECTDIR}/Journal.o
 
 # Source Files
-SOURCEFILES=SH1101A.c main.c TouchSense.c RGBLeds.c
+SOURCEFILES=SH1101A.c main.c TouchSense.c RGBLeds.c SysTick.c Scheduler.c SoftTimer.c Power.c Profile.c Clock.c Event.c Supervisor.c IrqMask.c Rtcc.c Flash.c UserStore.c Journal.c
 
 
 
@@ -113,6 +113,84 @@ ${OBJECTDIR}/RGBLeds.o: RGBLeds.c  .generated_files/flags/default/f7fc9df2ccc0b3
 	@${RM} ${OBJECTDIR}/RGBLeds.o 
 	${MP_CC} $(MP_EXTRA_CC_PRE)  RGBLeds.c  -o ${OBJECTDIR}/RGBLeds.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/RGBLeds.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
 	
+${OBJECTDIR}/SysTick.o: SysTick.c  .generated_files/flags/default/33a8546b21c225fb9c93bb516264587015e90e10 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/SysTick.o.d 
+	@${RM} ${OBJECTDIR}/SysTick.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  SysTick.c  -o ${OBJECTDIR}/SysTick.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/SysTick.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/Scheduler.o: Scheduler.c  .generated_files/flags/default/4ea57d7c91f51b9a6cd2b34f476565057e005677 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Scheduler.o.d 
+	@${RM} ${OBJECTDIR}/Scheduler.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  Scheduler.c  -o ${OBJECTDIR}/Scheduler.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/Scheduler.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/SoftTimer.o: SoftTimer.c  .generated_files/flags/default/30277c36b43c66245d12f41ab3be00b3bd2558ec .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/SoftTimer.o.d 
+	@${RM} ${OBJECTDIR}/SoftTimer.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  SoftTimer.c  -o ${OBJECTDIR}/SoftTimer.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/SoftTimer.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/Power.o: Power.c  .generated_files/flags/default/79e044bb42b8ea2a41f5025ed288ec9533f7b04a .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Power.o.d 
+	@${RM} ${OBJECTDIR}/Power.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  Power.c  -o ${OBJECTDIR}/Power.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/Power.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/Profile.o: Profile.c  .generated_files/flags/default/fc5e1f39623b6abfcbf87808e6f5398014a2b9aa .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Profile.o.d 
+	@${RM} ${OBJECTDIR}/Profile.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  Profile.c  -o ${OBJECTDIR}/Profile.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/Profile.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/Clock.o: Clock.c  .generated_files/flags/default/f7575674d86f77d995c167430eb6d104bad0955e .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Clock.o.d 
+	@${RM} ${OBJECTDIR}/Clock.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  Clock.c  -o ${OBJECTDIR}/Clock.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/Clock.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/Event.o: Event.c  .generated_files/flags/default/39e530f4a958835f91bef096ea470d6faee1b6e6 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Event.o.d 
+	@${RM} ${OBJECTDIR}/Event.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  Event.c  -o ${OBJECTDIR}/Event.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/Event.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/Supervisor.o: Supervisor.c  .generated_files/flags/default/f4689d273e5198d0cf004e9f3781eabe703a0210 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Supervisor.o.d 
+	@${RM} ${OBJECTDIR}/Supervisor.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  Supervisor.c  -o ${OBJECTDIR}/Supervisor.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/Supervisor.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/IrqMask.o: IrqMask.c  .generated_files/flags/default/09d83dc824c584f1c193452c4b9431a70ebbdb42 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/IrqMask.o.d 
+	@${RM} ${OBJECTDIR}/IrqMask.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  IrqMask.c  -o ${OBJECTDIR}/IrqMask.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/IrqMask.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/Rtcc.o: Rtcc.c  .generated_files/flags/default/641cfb75e99e7994ecd00f91fe7757d27f8a63ff .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Rtcc.o.d 
+	@${RM} ${OBJECTDIR}/Rtcc.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  Rtcc.c  -o ${OBJECTDIR}/Rtcc.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/Rtcc.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/Flash.o: Flash.c  .generated_files/flags/default/017cafa9cd429055932415f0b15b49bc058cdbc7 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Flash.o.d 
+	@${RM} ${OBJECTDIR}/Flash.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  Flash.c  -o ${OBJECTDIR}/Flash.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/Flash.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/UserStore.o: UserStore.c  .generated_files/flags/default/d00350de66abfa66995ed95c810a65a59feccacf .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/UserStore.o.d 
+	@${RM} ${OBJECTDIR}/UserStore.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  UserStore.c  -o ${OBJECTDIR}/UserStore.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/UserStore.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/Journal.o: Journal.c  .generated_files/flags/default/e206973afd3f3c559a94e42a587cce6feb1ace25 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Journal.o.d 
+	@${RM} ${OBJECTDIR}/Journal.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  Journal.c  -o ${OBJECTDIR}/Journal.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/Journal.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
 else
 ${OBJECTDIR}/SH1101A.o: SH1101A.c  .generated_files/flags/default/967b33b59cb192bcc51907d0d7e558e6b1f0f601 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}" 
@@ -138,6 +216,84 @@ ${OBJECTDIR}/RGBLeds.o: RGBLeds.c  .generated_files/flags/default/d057710249ffdc
 	@${RM} ${OBJECTDIR}/RGBLeds.o 
 	${MP_CC} $(MP_EXTRA_CC_PRE)  RGBLeds.c  -o ${OBJECTDIR}/RGBLeds.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/RGBLeds.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
 	
+${OBJECTDIR}/SysTick.o: SysTick.c  .generated_files/flags/default/ac6820821f3c950eb94edd31fc0438beec4a39eb .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/SysTick.o.d 
+	@${RM} ${OBJECTDIR}/SysTick.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  SysTick.c  -o ${OBJECTDIR}/SysTick.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/SysTick.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/Scheduler.o: Scheduler.c  .generated_files/flags/default/afe6d7a5d249f0b19c28646c22e530eab591afa3 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Scheduler.o.d 
+	@${RM} ${OBJECTDIR}/Scheduler.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  Scheduler.c  -o ${OBJECTDIR}/Scheduler.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/Scheduler.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/SoftTimer.o: SoftTimer.c  .generated_files/flags/default/6a30cf7f954906a8c161645e4d89ce3e4e5d85de .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/SoftTimer.o.d 
+	@${RM} ${OBJECTDIR}/SoftTimer.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  SoftTimer.c  -o ${OBJECTDIR}/SoftTimer.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/SoftTimer.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/Power.o: Power.c  .generated_files/flags/default/405a232799e9f53a7820589ab3ce1e45c235b388 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Power.o.d 
+	@${RM} ${OBJECTDIR}/Power.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  Power.c  -o ${OBJECTDIR}/Power.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/Power.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/Profile.o: Profile.c  .generated_files/flags/default/e0ad4432404c71a9e5c3f8c56a1dec8d86d62c4d .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Profile.o.d 
+	@${RM} ${OBJECTDIR}/Profile.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  Profile.c  -o ${OBJECTDIR}/Profile.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/Profile.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/Clock.o: Clock.c  .generated_files/flags/default/d166b9189be605c8e3213496f7da26c8b9782768 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Clock.o.d 
+	@${RM} ${OBJECTDIR}/Clock.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  Clock.c  -o ${OBJECTDIR}/Clock.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/Clock.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/Event.o: Event.c  .generated_files/flags/default/e223c3d64b68d1fd17e9d609ae6e357c2f472af4 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Event.o.d 
+	@${RM} ${OBJECTDIR}/Event.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  Event.c  -o ${OBJECTDIR}/Event.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/Event.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/Supervisor.o: Supervisor.c  .generated_files/flags/default/7cae0bc5d4cde8fcdcce2b051b1eecba62a0e82f .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Supervisor.o.d 
+	@${RM} ${OBJECTDIR}/Supervisor.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  Supervisor.c  -o ${OBJECTDIR}/Supervisor.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/Supervisor.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/IrqMask.o: IrqMask.c  .generated_files/flags/default/3dc4a0b6b71d6056085282b9e63eb5966104e670 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/IrqMask.o.d 
+	@${RM} ${OBJECTDIR}/IrqMask.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  IrqMask.c  -o ${OBJECTDIR}/IrqMask.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/IrqMask.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/Rtcc.o: Rtcc.c  .generated_files/flags/default/d3ef5b457783aebd7c91895bce331821cef3e582 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Rtcc.o.d 
+	@${RM} ${OBJECTDIR}/Rtcc.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  Rtcc.c  -o ${OBJECTDIR}/Rtcc.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/Rtcc.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/Flash.o: Flash.c  .generated_files/flags/default/ec6f266b5aa11f88f673f0bba951d04c457ab926 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Flash.o.d 
+	@${RM} ${OBJECTDIR}/Flash.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  Flash.c  -o ${OBJECTDIR}/Flash.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/Flash.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/UserStore.o: UserStore.c  .generated_files/flags/default/f9b47df4f55966c49beab95b07c40dce8cee41d2 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/UserStore.o.d 
+	@${RM} ${OBJECTDIR}/UserStore.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  UserStore.c  -o ${OBJECTDIR}/UserStore.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/UserStore.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/Journal.o: Journal.c  .generated_files/flags/default/1ab3ac4fd1e6536b403dd70ec7cf8405238ac6ed .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Journal.o.d 
+	@${RM} ${OBJECTDIR}/Journal.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  Journal.c  -o ${OBJECTDIR}/Journal.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/Journal.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
 endif
 
 # ------------------------------------------------------------------------------------